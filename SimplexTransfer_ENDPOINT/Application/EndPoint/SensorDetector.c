@@ -0,0 +1,227 @@
+/**
+ *  SensorDetector.c - occupied/free event detection on filtered sensor readings.
+ *
+ *  @version  1.0.00
+ *  @date     19 Oct 2026
+ *
+ *  assumptions
+ *  ===========
+ *  none
+ *
+ *  file dependency
+ *  ===============
+ *  SensorDetector.h : defines the detector interface.
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include "SensorDetector.h"
+
+// -----------------------------------------------------------------------------
+/**
+ *  Defines, enumerations, and structure definitions
+ */
+
+// -----------------------------------------------------------------------------
+/**
+ *  Global data
+ */
+
+// -----------------------------------------------------------------------------
+/**
+ *  Private interface
+ */
+
+// -----------------------------------------------------------------------------
+/**
+ *  Public interface
+ */
+
+void SensorDetectorInit(struct sSensorDetector *detector,
+                        struct sSensorFilter *filter)
+{
+  detector->filter = filter;
+  detector->state = eSensorStateFree;
+  detector->debounce = 0;
+  detector->transitions = 0;
+  detector->deviation = 0;
+}
+
+bool SensorDetectorUpdate(struct sSensorDetector *detector, long value)
+{
+  long magnitude;
+  bool towardsChange;
+
+  detector->deviation = value - SensorFilterGetBaseline(detector->filter);
+  magnitude = (detector->deviation < 0) ? -detector->deviation : detector->deviation;
+
+  if (detector->state == eSensorStateFree)
+  {
+    towardsChange = (magnitude >= SENSOR_DETECTOR_ENTER_THRESHOLD);
+  }
+  else
+  {
+    towardsChange = (magnitude < SENSOR_DETECTOR_EXIT_THRESHOLD);
+  }
+
+  if (!towardsChange)
+  {
+    detector->debounce = 0;
+
+    // Track drift only while nothing is present.
+    if (detector->state == eSensorStateFree)
+    {
+      SensorFilterBaseline(detector->filter, value);
+    }
+    return false;
+  }
+
+  if (++detector->debounce < SENSOR_DETECTOR_DEBOUNCE)
+  {
+    return false;
+  }
+
+  detector->debounce = 0;
+  detector->transitions++;
+  detector->state = (detector->state == eSensorStateFree) ?
+    eSensorStateOccupied : eSensorStateFree;
+
+  return true;
+}
+
+enum eSensorState SensorDetectorGetState(const struct sSensorDetector *detector)
+{
+  return detector->state;
+}
+
+bool SensorDetectorIsPending(const struct sSensorDetector *detector)
+{
+  return (detector->debounce != 0);
+}
+
+unsigned char SensorDetectorBuildPayload(const struct sSensorDetector *detector,
+                                         unsigned char *payload)
+{
+  unsigned long deviation = (unsigned long)detector->deviation;
+
+  payload[0] = (unsigned char)detector->state;
+  payload[1] = detector->transitions;
+  payload[2] = (unsigned char)(deviation >> 24);
+  payload[3] = (unsigned char)(deviation >> 16);
+  payload[4] = (unsigned char)(deviation >> 8);
+  payload[5] = (unsigned char)deviation;
+
+  return SENSOR_DETECTOR_PAYLOAD_LENGTH;
+}
+
+// -----------------------------------------------------------------------------
+/**
+ *  Test stub - test functionality of sensor detector module.
+ */
+
+/**
+ *  To test this module, define the following in your compiler preprocessor
+ *  definitions: "TEST_SENSOR_DETECTOR". SensorFilter.c must be linked as well.
+ *
+ *  It is strongly suggested that you leave the test stub in this source file.
+ *  This stub will allow you to easily test your implementation using unit tests
+ *  defined and by adding more to suit your application needs.
+ */
+#ifdef TEST_SENSOR_DETECTOR
+
+/**
+ *  Test Example - test the functionality of the event detector against a
+ *  sequence of filtered readings.
+ *
+ *  @version    1.0.00
+ *  @date       19 Oct 2026
+ *  @platform   Host PC
+ *  @compiler   Any ANSI C compiler
+ *
+ *  assumptions
+ *  ===========
+ *  - default thresholds (enter 100, exit 50, debounce 2).
+ *
+ *  file dependency
+ *  ===============
+ *  stdio.h : used to report the test results
+ *  string.h : used to compare payloads
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include <stdio.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+
+static unsigned int gFailures;
+
+static void TestCheck(bool condition, const char *name)
+{
+  if (!condition)
+  {
+    printf("FAIL: %s\n", name);
+    gFailures++;
+  }
+}
+
+int main(void)
+{
+  /**
+   *  Slow drift, a single-reading spike (debounced), an event that decays
+   *  through the hysteresis band, and the return to free.
+   */
+  static const long readings[] = {
+    40000, 40004, 40008, 40012,   // Drift is tracked
+    40200,                        // Spike: not confirmed
+    40012, 40200, 40210,          // Event confirmed on the second reading
+    40090, 40070, 40060,          // Inside hysteresis: still occupied
+    40040, 40030,                 // Free confirmed on the second reading
+  };
+  static const unsigned char changes[] = { 7, 12 };
+  static const unsigned char occupied[] = { 0x01, 0x01, 0x00, 0x00, 0x00, 0xD0 };
+  struct sSensorFilter filter;
+  struct sSensorDetector detector;
+  unsigned char payload[SENSOR_DETECTOR_PAYLOAD_LENGTH];
+  unsigned char change = 0;
+  unsigned char i;
+  long baseline = 0;
+
+  SensorFilterInit(&filter);
+  SensorFilterBaseline(&filter, readings[0]);
+  SensorDetectorInit(&detector, &filter);
+
+  for (i = 0; i < sizeof(readings) / sizeof(readings[0]); i++)
+  {
+    if (SensorDetectorUpdate(&detector, readings[i]))
+    {
+      TestCheck(change < sizeof(changes) && changes[change] == i, "state change index");
+      change++;
+
+      if (SensorDetectorGetState(&detector) == eSensorStateOccupied)
+      {
+        baseline = SensorFilterGetBaseline(&filter);
+        SensorDetectorBuildPayload(&detector, payload);
+        TestCheck(memcmp(payload, occupied, sizeof(payload)) == 0, "event payload");
+      }
+      else
+      {
+        TestCheck(SensorFilterGetBaseline(&filter) == baseline, "baseline frozen");
+      }
+    }
+  }
+
+  TestCheck(change == sizeof(changes), "state change count");
+  TestCheck(SensorDetectorGetState(&detector) == eSensorStateFree, "final state");
+
+  printf("%s: %u failure(s)\n", SENSOR_DETECTOR_INFO, gFailures);
+
+  return (gFailures == 0) ? 0 : 1;
+}
+
+#endif  /* TEST_SENSOR_DETECTOR */
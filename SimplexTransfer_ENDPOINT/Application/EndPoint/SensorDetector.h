@@ -0,0 +1,142 @@
+#ifndef SENSOR_DETECTOR_H
+#define SENSOR_DETECTOR_H
+/**
+ *  SensorDetector.h - occupied/free event detection on filtered sensor readings.
+ *
+ *  @version  1.0.00
+ *  @date     19 Oct 2026
+ *
+ *  The detector compares each filtered reading against the sensor filter
+ *  baseline. The baseline keeps tracking slow drift (temperature, supply) while
+ *  the detector is free and is frozen while an event is pending or active. A
+ *  state change requires SENSOR_DETECTOR_DEBOUNCE consecutive readings beyond
+ *  the threshold of the target state; the enter and exit thresholds differ to
+ *  provide hysteresis.
+ *
+ *  assumptions
+ *  ===========
+ *  - "NULL" is not a valid argument for pointer parameters unless the function
+ *  definition explicitly states that it is.
+ *  - the module does not access any hardware.
+ *
+ *  file dependency
+ *  ===============
+ *  SensorFilter.h : provides the baseline tracker.
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#define SENSOR_DETECTOR_INFO "SENSOR_DETECTOR 1.0.00"
+
+#include "SensorFilter.h"
+
+// -----------------------------------------------------------------------------
+/**
+ *  Defines, enumerations, and structure definitions
+ */
+
+// Deviation from the baseline that enters the occupied state
+#ifndef SENSOR_DETECTOR_ENTER_THRESHOLD
+#define SENSOR_DETECTOR_ENTER_THRESHOLD   100
+#endif
+
+// Deviation from the baseline below which the free state is re-entered
+#ifndef SENSOR_DETECTOR_EXIT_THRESHOLD
+#define SENSOR_DETECTOR_EXIT_THRESHOLD    50
+#endif
+
+// Consecutive readings required to confirm a state change
+#ifndef SENSOR_DETECTOR_DEBOUNCE
+#define SENSOR_DETECTOR_DEBOUNCE          2
+#endif
+
+#if (SENSOR_DETECTOR_EXIT_THRESHOLD > SENSOR_DETECTOR_ENTER_THRESHOLD)
+#error "Sensor Detector Error 0100: Exit threshold must not exceed the enter threshold."
+#endif
+
+/**
+ *  Event payload layout (all multi-byte fields are big-endian):
+ *
+ *    | state (1) | transition count (1) | deviation from baseline (4) |
+ */
+#define SENSOR_DETECTOR_PAYLOAD_LENGTH    6
+
+/**
+ *  eSensorState - detector states.
+ */
+enum eSensorState
+{
+  eSensorStateFree = 0x00,
+  eSensorStateOccupied = 0x01
+};
+
+/**
+ *  sSensorDetector - detector state.
+ */
+struct sSensorDetector
+{
+  struct sSensorFilter *filter;       // Filter providing the baseline
+  enum eSensorState state;            // Current (confirmed) state
+  unsigned char debounce;             // Consecutive readings towards a change
+  unsigned char transitions;          // Number of confirmed state changes
+  long deviation;                     // Last deviation from the baseline
+};
+
+// -----------------------------------------------------------------------------
+/**
+ *  Public interface
+ */
+
+/**
+ *  SensorDetectorInit - initialize the detector in the free state.
+ *
+ *    @param  detector  Detector instance.
+ *    @param  filter    Filter whose baseline is used. It must already be seeded.
+ */
+void SensorDetectorInit(struct sSensorDetector *detector,
+                        struct sSensorFilter *filter);
+
+/**
+ *  SensorDetectorUpdate - process a filtered reading. The baseline is updated
+ *  only while the detector is free and no change is pending.
+ *
+ *    @param  detector  Detector instance.
+ *    @param  value     Filtered reading.
+ *
+ *    @return True if the reading confirmed a state change, otherwise false.
+ */
+bool SensorDetectorUpdate(struct sSensorDetector *detector, long value);
+
+/**
+ *  SensorDetectorGetState - get the current (confirmed) state.
+ *
+ *    @param  detector  Detector instance.
+ *
+ *    @return Current state.
+ */
+enum eSensorState SensorDetectorGetState(const struct sSensorDetector *detector);
+
+/**
+ *  SensorDetectorIsPending - determine if a state change is being debounced.
+ *
+ *    @param  detector  Detector instance.
+ *
+ *    @return True if at least one reading points towards a state change that
+ *            has not been confirmed yet, otherwise false.
+ */
+bool SensorDetectorIsPending(const struct sSensorDetector *detector);
+
+/**
+ *  SensorDetectorBuildPayload - build the event payload for the current state.
+ *
+ *    @param  detector  Detector instance.
+ *    @param  payload   Buffer of at least SENSOR_DETECTOR_PAYLOAD_LENGTH bytes.
+ *
+ *    @return Number of payload bytes written.
+ */
+unsigned char SensorDetectorBuildPayload(const struct sSensorDetector *detector,
+                                         unsigned char *payload);
+
+#endif  /* SENSOR_DETECTOR_H */
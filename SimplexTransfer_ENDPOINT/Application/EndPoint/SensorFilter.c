@@ -0,0 +1,261 @@
+/**
+ *  SensorFilter.c - filtering pipeline for the RC discharge sensor readings.
+ *
+ *  @version  1.0.00
+ *  @date     19 Oct 2026
+ *
+ *  assumptions
+ *  ===========
+ *  - readings are small enough that a reading scaled by 2^SENSOR_FILTER_
+ *  BASELINE_SHIFT fits in a long.
+ *
+ *  file dependency
+ *  ===============
+ *  SensorFilter.h : defines the filtering pipeline interface.
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include "SensorFilter.h"
+
+// -----------------------------------------------------------------------------
+/**
+ *  Defines, enumerations, and structure definitions
+ */
+
+// Baseline IIR scale factor
+#define SENSOR_FILTER_BASELINE_SCALE  (1L << SENSOR_FILTER_BASELINE_SHIFT)
+
+// -----------------------------------------------------------------------------
+/**
+ *  Global data
+ */
+
+// -----------------------------------------------------------------------------
+/**
+ *  Private interface
+ */
+
+// -----------------------------------------------------------------------------
+/**
+ *  Public interface
+ */
+
+void SensorFilterInit(struct sSensorFilter *filter)
+{
+  filter->count = 0;
+  filter->accumulator = 0;
+  filter->seeded = false;
+}
+
+long SensorFilterConvert(const long *time)
+{
+  long delta = time[0] - time[2];
+  long divisor = 2 * delta - time[1];
+
+  if (divisor == 0)
+  {
+    return 0;
+  }
+
+  /**
+   *  B = (2e6 * (T0 - T2)) / (29 * (2 * (T0 - T2) - T1))
+   *
+   *  Note: The numerator exceeds the range of a long for large discharge times,
+   *  so the division is performed in floating point.
+   */
+  return (long)((2000000.0f * (float)delta) / (29.0f * (float)divisor));
+}
+
+long SensorFilterMedian(long *sample, unsigned char count)
+{
+  unsigned char i, j;
+  long value;
+
+  // Insertion sort; the set never exceeds SENSOR_FILTER_OVERSAMPLE readings.
+  for (i = 1; i < count; i++)
+  {
+    value = sample[i];
+    for (j = i; j > 0 && sample[j - 1] > value; j--)
+    {
+      sample[j] = sample[j - 1];
+    }
+    sample[j] = value;
+  }
+
+  return sample[count >> 1];
+}
+
+long SensorFilterOversample(struct sSensorFilter *filter, long (*Sample)(void))
+{
+  long value;
+  long minimum = 0;
+  long maximum = 0;
+
+  filter->count = 0;
+  while (filter->count < SENSOR_FILTER_OVERSAMPLE)
+  {
+    value = Sample();
+    if (filter->count == 0 || value < minimum)
+    {
+      minimum = value;
+    }
+    if (filter->count == 0 || value > maximum)
+    {
+      maximum = value;
+    }
+    filter->sample[filter->count++] = value;
+
+    // Stop early once enough readings agree. The first oversample always uses
+    // every reading since it seeds the baseline.
+    if (filter->seeded && filter->count >= SENSOR_FILTER_MEDIAN_SIZE &&
+        (maximum - minimum) <= SENSOR_FILTER_EARLY_STOP_SPREAD)
+    {
+      break;
+    }
+  }
+
+  return SensorFilterMedian(filter->sample, filter->count);
+}
+
+long SensorFilterBaseline(struct sSensorFilter *filter, long value)
+{
+  if (!filter->seeded)
+  {
+    filter->accumulator = value * SENSOR_FILTER_BASELINE_SCALE;
+    filter->seeded = true;
+  }
+  else
+  {
+    filter->accumulator += value - (filter->accumulator / SENSOR_FILTER_BASELINE_SCALE);
+  }
+
+  return SensorFilterGetBaseline(filter);
+}
+
+long SensorFilterGetBaseline(const struct sSensorFilter *filter)
+{
+  return filter->accumulator / SENSOR_FILTER_BASELINE_SCALE;
+}
+
+unsigned char SensorFilterGetSampleCount(const struct sSensorFilter *filter)
+{
+  return filter->count;
+}
+
+// -----------------------------------------------------------------------------
+/**
+ *  Test stub - test functionality of sensor filter module.
+ */
+
+/**
+ *  To test this module, define the following in your compiler preprocessor
+ *  definitions: "TEST_SENSOR_FILTER".
+ *
+ *  It is strongly suggested that you leave the test stub in this source file.
+ *  This stub will allow you to easily test your implementation using unit tests
+ *  defined and by adding more to suit your application needs.
+ */
+#ifdef TEST_SENSOR_FILTER
+
+/**
+ *  Test Example - test the functionality of the sensor filtering pipeline
+ *  against a recorded discharge time trace.
+ *
+ *  @version    1.0.00
+ *  @date       19 Oct 2026
+ *  @platform   Host PC
+ *  @compiler   Any ANSI C compiler
+ *
+ *  assumptions
+ *  ===========
+ *  none
+ *
+ *  file dependency
+ *  ===============
+ *  stdio.h : used to report the test results
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+
+// Recorded Time[] trace (P2.3, P2.2, P2.1 discharge times in SMCLK cycles).
+// Entry 3 is a spike caused by an interrupted discharge.
+static const long gTrace[][3] = {
+  { 8000, 1380, 3000 }, { 8001, 1381, 3000 }, { 7999, 1380, 3001 },
+  { 8000, 2900, 3000 }, { 8000, 1379, 3000 }, { 8001, 1380, 3001 },
+  { 8000, 1380, 3000 }, { 7999, 1381, 3000 }, { 8000, 1380, 3001 },
+  { 8001, 1380, 3000 }, { 8000, 1379, 3000 }, { 8000, 1380, 3001 }
+};
+static unsigned char gTraceIndex;
+
+static long TestSample(void)
+{
+  const long *time = gTrace[gTraceIndex];
+
+  gTraceIndex = (gTraceIndex + 1) % (sizeof(gTrace) / sizeof(gTrace[0]));
+
+  return SensorFilterConvert(time);
+}
+
+static unsigned int gFailures;
+
+static void TestCheck(bool condition, const char *name)
+{
+  if (!condition)
+  {
+    printf("FAIL: %s\n", name);
+    gFailures++;
+  }
+}
+
+int main(void)
+{
+  struct sSensorFilter filter;
+  long sample[5] = { 7, 3, 100, 5, 4 };
+  long value;
+  long time[3] = { 100, 50, 100 };
+
+  // Median rejects a single spike.
+  TestCheck(SensorFilterMedian(sample, 5) == 5, "median of five");
+  TestCheck(SensorFilterMedian(sample, 1) == 3, "median of one");
+
+  // Degenerate times do not divide by zero.
+  time[1] = 0;
+  TestCheck(SensorFilterConvert(time) == 0, "degenerate conversion");
+
+  // The first oversample seeds the baseline and uses every reading; the spike
+  // in the trace is rejected by the median.
+  SensorFilterInit(&filter);
+  value = SensorFilterOversample(&filter, TestSample);
+  TestCheck(SensorFilterGetSampleCount(&filter) == SENSOR_FILTER_OVERSAMPLE,
+            "seeding oversample uses every reading");
+  TestCheck(value - SensorFilterConvert(gTrace[0]) <= SENSOR_FILTER_EARLY_STOP_SPREAD &&
+            SensorFilterConvert(gTrace[0]) - value <= SENSOR_FILTER_EARLY_STOP_SPREAD,
+            "spike rejected");
+  TestCheck(SensorFilterBaseline(&filter, value) == value, "baseline seeded");
+
+  // Subsequent oversamples terminate early on a quiet trace.
+  value = SensorFilterOversample(&filter, TestSample);
+  TestCheck(SensorFilterGetSampleCount(&filter) < SENSOR_FILTER_OVERSAMPLE,
+            "early termination");
+
+  // The baseline moves towards a step by 1 / 2^shift per update.
+  SensorFilterInit(&filter);
+  SensorFilterBaseline(&filter, 1000);
+  TestCheck(SensorFilterBaseline(&filter, 1000 + SENSOR_FILTER_BASELINE_SCALE) == 1001,
+            "baseline step response");
+
+  printf("%s: %u failure(s)\n", SENSOR_FILTER_INFO, gFailures);
+
+  return (gFailures == 0) ? 0 : 1;
+}
+
+#endif  /* TEST_SENSOR_FILTER */
@@ -0,0 +1,165 @@
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+/**
+ *  SensorFilter.h - filtering pipeline for the RC discharge sensor readings.
+ *
+ *  @version  1.0.00
+ *  @date     19 Oct 2026
+ *
+ *  The pipeline has three stages:
+ *    1. Oversampling - up to SENSOR_FILTER_OVERSAMPLE raw readings are taken.
+ *       Sampling stops early once SENSOR_FILTER_MEDIAN_SIZE readings agree
+ *       within SENSOR_FILTER_EARLY_STOP_SPREAD.
+ *    2. Median - the median of the collected readings rejects spikes.
+ *    3. Baseline - a fixed-point first order IIR tracks the median output.
+ *
+ *  assumptions
+ *  ===========
+ *  - "NULL" is not a valid argument for pointer parameters unless the function
+ *  definition explicitly states that it is.
+ *  - the module does not access any hardware. Raw readings are obtained through
+ *  the sample callback so the pipeline can be run on recorded traces.
+ *
+ *  file dependency
+ *  ===============
+ *  none
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#define SENSOR_FILTER_INFO "SENSOR_FILTER 1.0.00"
+
+#ifndef bool
+#define bool unsigned char
+#endif
+
+#ifndef true
+#define true 1
+#endif
+
+#ifndef false
+#define false 0
+#endif
+
+// -----------------------------------------------------------------------------
+/**
+ *  Defines, enumerations, and structure definitions
+ */
+
+#ifndef NULL
+#define NULL  (void*)0
+#endif
+
+// Maximum number of raw readings per filtered reading
+#ifndef SENSOR_FILTER_OVERSAMPLE
+#define SENSOR_FILTER_OVERSAMPLE          8
+#endif
+
+// Minimum number of raw readings before early termination is considered
+#ifndef SENSOR_FILTER_MEDIAN_SIZE
+#define SENSOR_FILTER_MEDIAN_SIZE         3
+#endif
+
+// Maximum spread (max - min) of the readings that allows early termination
+#ifndef SENSOR_FILTER_EARLY_STOP_SPREAD
+#define SENSOR_FILTER_EARLY_STOP_SPREAD   32
+#endif
+
+// Baseline IIR coefficient expressed as a shift (alpha = 1 / 2^shift)
+#ifndef SENSOR_FILTER_BASELINE_SHIFT
+#define SENSOR_FILTER_BASELINE_SHIFT      4
+#endif
+
+#if (SENSOR_FILTER_MEDIAN_SIZE > SENSOR_FILTER_OVERSAMPLE)
+#error "Sensor Filter Error 0100: Median size must not exceed the oversample count."
+#endif
+
+/**
+ *  sSensorFilter - filtering pipeline state.
+ */
+struct sSensorFilter
+{
+  long sample[SENSOR_FILTER_OVERSAMPLE];  // Raw readings of the last oversample
+  unsigned char count;                    // Number of raw readings collected
+  long accumulator;                       // Baseline scaled by 2^shift
+  bool seeded;                            // Baseline has been initialized
+};
+
+// -----------------------------------------------------------------------------
+/**
+ *  Public interface
+ */
+
+/**
+ *  SensorFilterInit - initialize the filtering pipeline. The baseline is seeded
+ *  by the first value passed to SensorFilterBaseline.
+ *
+ *    @param  filter  Filter instance.
+ */
+void SensorFilterInit(struct sSensorFilter *filter);
+
+/**
+ *  SensorFilterConvert - convert the three discharge times of one charge/
+ *  discharge sequence to a sensor reading.
+ *
+ *    @param  time  Discharge times through P2.3, P2.2 and P2.1 (in order).
+ *
+ *    @return The sensor reading. Zero if the times are degenerate.
+ */
+long SensorFilterConvert(const long *time);
+
+/**
+ *  SensorFilterMedian - get the median of a set of readings. The set is sorted
+ *  in place.
+ *
+ *    @param  sample  Readings.
+ *    @param  count   Number of readings (must be greater than zero).
+ *
+ *    @return The median reading.
+ */
+long SensorFilterMedian(long *sample, unsigned char count);
+
+/**
+ *  SensorFilterOversample - take raw readings and return their median. Until
+ *  the baseline has been seeded all SENSOR_FILTER_OVERSAMPLE readings are taken,
+ *  which replaces a separate warm-up.
+ *
+ *    @param  filter  Filter instance.
+ *    @param  Sample  Callback that performs one raw reading.
+ *
+ *    @return The filtered reading.
+ */
+long SensorFilterOversample(struct sSensorFilter *filter, long (*Sample)(void));
+
+/**
+ *  SensorFilterBaseline - feed a filtered reading to the baseline tracker.
+ *
+ *    @param  filter  Filter instance.
+ *    @param  value   Filtered reading.
+ *
+ *    @return The updated baseline.
+ */
+long SensorFilterBaseline(struct sSensorFilter *filter, long value);
+
+/**
+ *  SensorFilterGetBaseline - get the current baseline.
+ *
+ *    @param  filter  Filter instance.
+ *
+ *    @return The current baseline.
+ */
+long SensorFilterGetBaseline(const struct sSensorFilter *filter);
+
+/**
+ *  SensorFilterGetSampleCount - get the number of raw readings taken by the
+ *  last oversample.
+ *
+ *    @param  filter  Filter instance.
+ *
+ *    @return Number of raw readings.
+ */
+unsigned char SensorFilterGetSampleCount(const struct sSensorFilter *filter);
+
+#endif  /* SENSOR_FILTER_H */
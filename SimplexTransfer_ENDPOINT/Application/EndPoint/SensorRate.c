@@ -0,0 +1,185 @@
+/**
+ *  SensorRate.c - adaptive sampling period controller.
+ *
+ *  @version  1.0.00
+ *  @date     19 Oct 2026
+ *
+ *  assumptions
+ *  ===========
+ *  none
+ *
+ *  file dependency
+ *  ===============
+ *  SensorRate.h : defines the controller interface.
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include "SensorRate.h"
+
+// -----------------------------------------------------------------------------
+/**
+ *  Defines, enumerations, and structure definitions
+ */
+
+// Largest reading change used for the variance (keeps the square in a long)
+#define SENSOR_RATE_MAX_CHANGE        32767L
+
+// -----------------------------------------------------------------------------
+/**
+ *  Global data
+ */
+
+// -----------------------------------------------------------------------------
+/**
+ *  Private interface
+ */
+
+// -----------------------------------------------------------------------------
+/**
+ *  Public interface
+ */
+
+void SensorRateInit(struct sSensorRate *rate)
+{
+  rate->period = SENSOR_RATE_MIN_PERIOD;
+  rate->previous = 0;
+  rate->variance = 0;
+  rate->primed = false;
+}
+
+unsigned int SensorRateUpdate(struct sSensorRate *rate, long value, bool active)
+{
+  long change = value - rate->previous;
+
+  if (!rate->primed)
+  {
+    change = 0;
+    rate->primed = true;
+  }
+  rate->previous = value;
+
+  if (change < 0)
+  {
+    change = -change;
+  }
+  if (change > SENSOR_RATE_MAX_CHANGE)
+  {
+    change = SENSOR_RATE_MAX_CHANGE;
+  }
+
+  // Exponentially weighted variance of the change between readings.
+  rate->variance += ((change * change) - rate->variance) / (1L << SENSOR_RATE_VARIANCE_SHIFT);
+
+  if (active || rate->variance > SENSOR_RATE_VARIANCE_THRESHOLD)
+  {
+    rate->period = SENSOR_RATE_MIN_PERIOD;
+  }
+  else if (rate->period > SENSOR_RATE_MAX_PERIOD / SENSOR_RATE_BACKOFF_FACTOR)
+  {
+    rate->period = SENSOR_RATE_MAX_PERIOD;
+  }
+  else
+  {
+    rate->period *= SENSOR_RATE_BACKOFF_FACTOR;
+  }
+
+  return rate->period;
+}
+
+unsigned int SensorRateGetPeriod(const struct sSensorRate *rate)
+{
+  return rate->period;
+}
+
+// -----------------------------------------------------------------------------
+/**
+ *  Test stub - test functionality of sensor rate module.
+ */
+
+/**
+ *  To test this module, define the following in your compiler preprocessor
+ *  definitions: "TEST_SENSOR_RATE".
+ *
+ *  It is strongly suggested that you leave the test stub in this source file.
+ *  This stub will allow you to easily test your implementation using unit tests
+ *  defined and by adding more to suit your application needs.
+ */
+#ifdef TEST_SENSOR_RATE
+
+/**
+ *  Test Example - test the back-off and snap behaviour of the controller.
+ *
+ *  @version    1.0.00
+ *  @date       19 Oct 2026
+ *  @platform   Host PC
+ *  @compiler   Any ANSI C compiler
+ *
+ *  assumptions
+ *  ===========
+ *  - default parameters (13 to 512 ticks, factor 2, threshold 400, shift 2).
+ *
+ *  file dependency
+ *  ===============
+ *  stdio.h : used to report the test results
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+
+static unsigned int gFailures;
+
+static void TestCheck(bool condition, const char *name)
+{
+  if (!condition)
+  {
+    printf("FAIL: %s\n", name);
+    gFailures++;
+  }
+}
+
+int main(void)
+{
+  struct sSensorRate rate;
+  unsigned char i;
+
+  SensorRateInit(&rate);
+  TestCheck(SensorRateGetPeriod(&rate) == SENSOR_RATE_MIN_PERIOD, "initial period");
+
+  // A quiet signal backs off exponentially and saturates at the maximum.
+  TestCheck(SensorRateUpdate(&rate, 40000, false) == 26, "first back-off");
+  TestCheck(SensorRateUpdate(&rate, 40002, false) == 52, "second back-off");
+  for (i = 0; i < 10; i++)
+  {
+    SensorRateUpdate(&rate, 40000 + (i & 1), false);
+  }
+  TestCheck(SensorRateGetPeriod(&rate) == SENSOR_RATE_MAX_PERIOD, "saturated period");
+
+  // A large change raises the variance and snaps to the fast period.
+  TestCheck(SensorRateUpdate(&rate, 40100, false) == SENSOR_RATE_MIN_PERIOD,
+            "variance snap");
+
+  // The variance decays, then the period backs off again.
+  for (i = 0; i < 8; i++)
+  {
+    SensorRateUpdate(&rate, 40100, false);
+  }
+  TestCheck(SensorRateGetPeriod(&rate) > SENSOR_RATE_MIN_PERIOD, "variance decay");
+
+  // Detector activity snaps to the fast period regardless of the variance.
+  TestCheck(SensorRateUpdate(&rate, 40100, true) == SENSOR_RATE_MIN_PERIOD,
+            "activity snap");
+
+  printf("%s: %u failure(s)\n", SENSOR_RATE_INFO, gFailures);
+
+  return (gFailures == 0) ? 0 : 1;
+}
+
+#endif  /* TEST_SENSOR_RATE */
@@ -0,0 +1,129 @@
+#ifndef SENSOR_RATE_H
+#define SENSOR_RATE_H
+/**
+ *  SensorRate.h - adaptive sampling period controller.
+ *
+ *  @version  1.0.00
+ *  @date     19 Oct 2026
+ *
+ *  The controller keeps an exponentially weighted variance of the change
+ *  between consecutive filtered readings. While the variance stays below
+ *  SENSOR_RATE_VARIANCE_THRESHOLD the sampling period is multiplied by
+ *  SENSOR_RATE_BACKOFF_FACTOR up to SENSOR_RATE_MAX_PERIOD. When the variance
+ *  exceeds the threshold, or the caller reports detector activity, the period
+ *  snaps back to SENSOR_RATE_MIN_PERIOD.
+ *
+ *  Periods are expressed in application ticks (e.g. watchdog intervals).
+ *
+ *  assumptions
+ *  ===========
+ *  - "NULL" is not a valid argument for pointer parameters unless the function
+ *  definition explicitly states that it is.
+ *  - the module does not access any hardware.
+ *
+ *  file dependency
+ *  ===============
+ *  none
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#define SENSOR_RATE_INFO "SENSOR_RATE 1.0.00"
+
+#ifndef bool
+#define bool unsigned char
+#endif
+
+#ifndef true
+#define true 1
+#endif
+
+#ifndef false
+#define false 0
+#endif
+
+// -----------------------------------------------------------------------------
+/**
+ *  Defines, enumerations, and structure definitions
+ */
+
+// Shortest sampling period (ticks)
+#ifndef SENSOR_RATE_MIN_PERIOD
+#define SENSOR_RATE_MIN_PERIOD            13
+#endif
+
+// Longest sampling period (ticks)
+#ifndef SENSOR_RATE_MAX_PERIOD
+#define SENSOR_RATE_MAX_PERIOD            512
+#endif
+
+// Period multiplier applied on every quiet reading
+#ifndef SENSOR_RATE_BACKOFF_FACTOR
+#define SENSOR_RATE_BACKOFF_FACTOR        2
+#endif
+
+// Variance (reading units squared) above which the fast period is used
+#ifndef SENSOR_RATE_VARIANCE_THRESHOLD
+#define SENSOR_RATE_VARIANCE_THRESHOLD    400
+#endif
+
+// Variance IIR coefficient expressed as a shift (alpha = 1 / 2^shift)
+#ifndef SENSOR_RATE_VARIANCE_SHIFT
+#define SENSOR_RATE_VARIANCE_SHIFT        2
+#endif
+
+#if (SENSOR_RATE_MIN_PERIOD == 0) || (SENSOR_RATE_MIN_PERIOD > SENSOR_RATE_MAX_PERIOD)
+#error "Sensor Rate Error 0100: Invalid sampling period range."
+#endif
+
+#if (SENSOR_RATE_BACKOFF_FACTOR < 1)
+#error "Sensor Rate Error 0101: Back-off factor must be at least 1."
+#endif
+
+/**
+ *  sSensorRate - controller state.
+ */
+struct sSensorRate
+{
+  unsigned int period;                // Current sampling period (ticks)
+  long previous;                      // Previous filtered reading
+  long variance;                      // Variance of the reading change
+  bool primed;                        // A previous reading is available
+};
+
+// -----------------------------------------------------------------------------
+/**
+ *  Public interface
+ */
+
+/**
+ *  SensorRateInit - initialize the controller at the fast period.
+ *
+ *    @param  rate  Controller instance.
+ */
+void SensorRateInit(struct sSensorRate *rate);
+
+/**
+ *  SensorRateUpdate - process a filtered reading and select the next period.
+ *
+ *    @param  rate    Controller instance.
+ *    @param  value   Filtered reading.
+ *    @param  active  True if the threshold logic fired (e.g. a detector state
+ *                    change is pending or has just been confirmed).
+ *
+ *    @return The next sampling period (ticks).
+ */
+unsigned int SensorRateUpdate(struct sSensorRate *rate, long value, bool active);
+
+/**
+ *  SensorRateGetPeriod - get the current sampling period.
+ *
+ *    @param  rate  Controller instance.
+ *
+ *    @return Current sampling period (ticks).
+ */
+unsigned int SensorRateGetPeriod(const struct sSensorRate *rate);
+
+#endif  /* SENSOR_RATE_H */
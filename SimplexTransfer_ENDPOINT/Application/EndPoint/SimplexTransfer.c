@@ -41,9 +41,10 @@
 #endif
 
 #include "API.h"
+#include "SensorDetector.h"
+#include "SensorRate.h"
 
 #include <stdio.h>
-#include <math.h>
 
 //#define Sensor 1
 
@@ -75,6 +76,17 @@
 #define GDO0_EVENT    P2IFG
 #endif
 
+#if defined( PROTOCOL_USE_TDMA )
+/**
+ *  The link attempts are spaced by a random sleep of 1 to 2^exponent watchdog
+ *  intervals. The exponent grows after each unanswered attempt up to the 
+ *  maximum, so End Points waiting for a free slot neither retry in lockstep nor
+ *  keep the receiver on.
+ */
+#define LINK_BACKOFF_MIN_EXPONENT   2   // First backoff: up to 4 intervals (~64ms)
+#define LINK_BACKOFF_MAX_EXPONENT   8   // Longest backoff: up to 256 intervals (~4s)
+#endif
+
 /**
  *  sPacket - an example packet. The sequence number is used to demonstrate
  *  communication by sending the same message (payload) and incrementing the
@@ -120,9 +132,47 @@ static struct sPacket gPacket = {
 
 long Time[3];
 unsigned int i = 0;
-int wdtCounter = 0;
-float LastB;
-float ActualB;
+unsigned int wdtCounter = 0;
+long LastB;
+long ActualB;
+
+#ifdef Sensor
+// Oversampling, median and baseline filtering of the ReadB readings
+static struct sSensorFilter gSensorFilter;
+
+// Occupied/free detection; only state changes are transmitted
+static struct sSensorDetector gSensorDetector;
+static bool gSensorEventPending = false;
+
+// Adaptive sampling period
+static struct sSensorRate gSensorRate;
+#endif
+
+// Sampling period (in watchdog intervals)
+static volatile unsigned int gSensorPeriod = SENSOR_RATE_MIN_PERIOD;
+
+// Watchdog intervals until the watchdog interval timer wakes the main loop
+static volatile unsigned int gWatchdogIntervals = 1;
+
+#if defined( PROTOCOL_USE_TDMA )
+// Link backoff pseudo-random sequence (seeded with the local address)
+static unsigned int gLinkRandom;
+#endif
+
+#if defined( SENSOR_PARALLEL_CAPTURE )
+/**
+ *  Parallel capture wiring. Each electrode has its own sense node on a Timer1_A
+ *  capture input and all of them discharge through a common drain pin:
+ *    - Time[0] : P2.0 (TA1 CCI0A)
+ *    - Time[1] : P2.1 (TA1 CCI1A)
+ *    - Time[2] : P2.4 (TA1 CCI2A)
+ */
+#define SENSE_PARALLEL_INPUTS   (BIT0 | BIT1 | BIT4)
+#define SENSE_PARALLEL_DRAIN    BIT3
+#endif
+
+// Capture channels still waiting for their discharge edge (bit n = Time[n])
+static volatile unsigned char gCapturePending = 0;
 
 //------------------------------------------------------------------------------
 // Hardware-related definitions
@@ -163,33 +213,127 @@ void ChargingStep( int ChargingBit, int DischargingBits )
 
 void DischargingStep( int OutputBit, int InputBits, int ChargingBit )
 {
-	// Iniciar el temporizador y apagar poner el micro a estado de bajo consumo
+	// Acomodamos las patitas. The charge electrode must be an input before it
+	// is routed to Timer1_A: with P2DIR set, P2SEL would drive TA1.0 OUT0 (low)
+	// onto it and partly discharge it before the timer starts.
+	P2DIR = ( P2DIR | OutputBit ) & ~( InputBits | ChargingBit );
+
+	// Route the charge electrode to the Timer1_A CCI0A capture input (P2.0 is
+	// TA1.0). The falling edge at the end of the discharge latches TA1R into
+	// TA1CCR0 in hardware, so the timestamp does not include ISR latency.
+	TA1CTL = TASSEL_2 | MC_0 | TACLR;                 // SMCLK, stopped, cleared
+	TA1CCTL0 = CM_2 | CCIS_0 | SCS | CAP | CCIE;      // Falling edge, CCI0A, sync capture
+	gCapturePending = BIT0;
+	P2SEL2 &= ~ChargingBit;
+	P2SEL |= ChargingBit;
+
+	// Start the timer and the discharge back to back so the offset between
+	// both is a fixed number of cycles. The overflow bounds the wait.
+	TA1CTL = TASSEL_2 | MC_2 | TACLR | TAIE;          // SMCLK, continuous
+	P2OUT &= ~OutputBit;// Set P2.x at 0.0
 
-	// Inicializamos la interrupcin para finalizar la descarga y activar el micro
-	P2IES |= ChargingBit;   // high -> low is selected with IES.x = 1.
-	P2IFG &= ~ChargingBit;  // To prevent an immediate interrupt, clear the flag for
-	                        // P2.x before enabling the interrupt.
-	P2IE |= ChargingBit;    // Enable interrupts for P2.x
+	// Mandar a dormir el micro hasta la captura. The capture may already have
+	// happened, so only sleep while it is pending.
+	__disable_interrupt();
+	while (gCapturePending)
+	{
+		_BIS_SR(LPM1_bits + GIE);
+		__disable_interrupt();
+	}
 	__enable_interrupt();
 
-	// Acomodamos las patitas
-	P2DIR = ( P2DIR | OutputBit ) & ~InputBits;
-	P2OUT &= ~OutputBit;// Set P2.x at 0.0
+	P2SEL &= ~ChargingBit;
+}
 
-	// Iniciar el temporizador y poner a dormir el micro
-	//TACCTL0 = CCIE;
-	//TACTL = TASSEL_2 + MC_2; // Set the timer A to SMCLCK, Continuous
-	TACTL = TASSEL_2 + MC_2; // Set the timer A to ACLK, Continuous
-	// Clear the timer and enable timer interrupt
-	TA0R = 0;
-    __enable_interrupt();
-	//__delay_cycles(1000);
-	// Mandar a dormir el micro
-	_BIS_SR(LPM1_bits + GIE); // Enter LPM3 w/interrupt
+#if defined( SENSOR_PARALLEL_CAPTURE )
+void ParallelDischargingStep(void)
+{
+	// The sense nodes must be inputs before they are routed to Timer1_A: with
+	// P2DIR set, P2SEL would drive the TA1.x OUTx outputs (low) onto them.
+	P2DIR = ( P2DIR | SENSE_PARALLEL_DRAIN ) & ~SENSE_PARALLEL_INPUTS;
+
+	// Route every sense node to its Timer1_A capture input. All channels share
+	// the same counter, so the three discharge times have no relative skew.
+	TA1CTL = TASSEL_2 | MC_0 | TACLR;                 // SMCLK, stopped, cleared
+	TA1CCTL0 = CM_2 | CCIS_0 | SCS | CAP | CCIE;      // Falling edge, CCI0A, sync capture
+	TA1CCTL1 = CM_2 | CCIS_0 | SCS | CAP | CCIE;      // Falling edge, CCI1A, sync capture
+	TA1CCTL2 = CM_2 | CCIS_0 | SCS | CAP | CCIE;      // Falling edge, CCI2A, sync capture
+	gCapturePending = BIT0 | BIT1 | BIT2;
+	P2SEL2 &= ~SENSE_PARALLEL_INPUTS;
+	P2SEL |= SENSE_PARALLEL_INPUTS;
+
+	// The overflow bounds the wait if an edge is missed.
+	TA1CTL = TASSEL_2 | MC_2 | TACLR | TAIE;          // SMCLK, continuous
+	P2OUT &= ~SENSE_PARALLEL_DRAIN;
+
+	// Sleep until the last edge has been captured or the counter wrapped.
+	__disable_interrupt();
+	while (gCapturePending)
+	{
+		_BIS_SR(LPM1_bits + GIE);
+		__disable_interrupt();
+	}
+	__enable_interrupt();
+
+	P2SEL &= ~SENSE_PARALLEL_INPUTS;
 }
 
-float ReadB()
+/**
+ *  SenseCapture - store the discharge time captured by a Timer1_A channel.
+ *
+ *    @param  channel Capture channel (Time[] index).
+ *    @param  count   Captured timer value.
+ *
+ *    @return True if every channel has captured its edge, otherwise false.
+ */
+bool SenseCapture(unsigned char channel, unsigned int count)
 {
+	Time[channel] = count;
+	gCapturePending &= ~(1 << channel);
+
+	return (gCapturePending == 0);
+}
+#endif
+
+/**
+ *  SenseTimeout - Timer1_A wrapped before every discharge edge was captured
+ *  (e.g. an open electrode). The missing channels read full scale.
+ */
+void SenseTimeout(void)
+{
+#if defined( SENSOR_PARALLEL_CAPTURE )
+	unsigned char channel;
+
+	for (channel = 0; channel < 3; channel++)
+	{
+		if (gCapturePending & (1 << channel))
+		{
+			Time[channel] = 0xFFFF;
+		}
+	}
+	TA1CCTL1 = 0;
+	TA1CCTL2 = 0;
+#else
+	Time[i] = 0xFFFF;
+#endif
+	TA1CCTL0 = 0;
+	gCapturePending = 0;
+	TA1CTL = MC_0;
+}
+
+long ReadB(void)
+{
+	// Timer1_A is shared with the protocol timer. Keep its configuration so it
+	// can be restored once the capture sequence is over.
+	unsigned int timerCtl = TA1CTL;
+	unsigned int timerCctl = TA1CCTL0;
+	unsigned int timerCcr = TA1CCR0;
+
+#if defined( SENSOR_PARALLEL_CAPTURE )
+	// A single charge and discharge measures the three electrodes at once.
+	ChargingStep( SENSE_PARALLEL_INPUTS, SENSE_PARALLEL_DRAIN );
+	ParallelDischargingStep();
+#else
 	// Carga y descarga para P2.3
 	i = 0;
 	ChargingStep( BIT0, BIT3 | BIT2 | BIT1 );
@@ -204,17 +348,13 @@ float ReadB()
 	i = 2;
 	ChargingStep( BIT0, BIT3 | BIT2 | BIT1 );
 	DischargingStep( BIT1, BIT0 | BIT2 | BIT3, BIT0 );
+#endif
 
-	//float x = 2.0f * (float)( Time[0] - Time[2] ) / (float)( Time[1] + Time[2] - Time[0] );
-
-	//float B = x / ( ( x - 2.0f ) * 14.5f );
-
-	long a = ( 1000000 * 2 * ( Time[0] - Time[2] ) );
-    // / ( 29.0 * ( 2.0 * (Time[0] - Time[2]) - Time[1] ) );
-
-	long b = ( 29 * ( 2 * (Time[0] - Time[2]) - Time[1] ) );
+	TA1CCR0 = timerCcr;
+	TA1CCTL0 = timerCctl & ~CCIFG;
+	TA1CTL = timerCtl;
 
-	return (float)a / (float)b;
+	return SensorFilterConvert(Time);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,6 +392,38 @@ bool PlatformInit(void)
   return true;
 }
 
+/**
+ *  WatchdogSleep - sleep in low power mode 3 for a number of watchdog intervals
+ *  (about 16ms each). The watchdog interval timer is stopped again on return.
+ *
+ *    @param  intervals Number of watchdog intervals (1 or more).
+ */
+void WatchdogSleep(unsigned int intervals)
+{
+	wdtCounter = 0;
+	gWatchdogIntervals = intervals;
+	WDTCTL = WDT_ADLY_16;
+	IE1 |= WDTIE;             // Enable WDT interrupt
+	_BIS_SR(LPM3_bits + GIE); // Enter LPM3 w/interrupt
+	WDTCTL = WDTPW + WDTHOLD;
+	IE1 &= ~WDTIE;
+}
+
+#if defined( PROTOCOL_USE_TDMA )
+/**
+ *  LinkBackoff - sleep for a random number of watchdog intervals before the next
+ *  link attempt (16-bit Galois LFSR, x^16 + x^14 + x^13 + x^11 + 1).
+ *
+ *    @param  exponent  Backoff exponent; the sleep lasts 1 to 2^exponent 
+ *                      watchdog intervals.
+ */
+void LinkBackoff(unsigned char exponent)
+{
+	gLinkRandom = (gLinkRandom >> 1) ^ (-(gLinkRandom & 1u) & 0xB400u);
+	WatchdogSleep(1 + (gLinkRandom & ((1u << exponent) - 1)));
+}
+#endif
+
 /**
  *  main - main application loop. Sets up platform and then performs simple
  *  transfers (simplex) while incrementing the sequence number for the lifetime 
@@ -295,59 +467,121 @@ int main(void)
 
 
 	#ifdef Sensor
-	LastB = ReadB();
-	__delay_cycles(70000 * 8 );
-	LastB = ReadB();
-	__delay_cycles(70000 * 8 );
-	LastB = ReadB();
-	__delay_cycles(70000 * 8 );
+	// The first oversample always takes every reading and seeds the baseline.
+	SensorFilterInit(&gSensorFilter);
+	LastB = SensorFilterBaseline(&gSensorFilter,
+	                             SensorFilterOversample(&gSensorFilter, ReadB));
+	SensorDetectorInit(&gSensorDetector, &gSensorFilter);
+	SensorRateInit(&gSensorRate);
+	#endif
+
+	#if defined( PROTOCOL_USE_TDMA )
+	// Link to the Gateway to be assigned a transmit slot. A Gateway without a
+	// free slot does not answer, so keep trying after a random exponential 
+	// backoff spent in LPM3.
+	{
+		unsigned char exponent = LINK_BACKOFF_MIN_EXPONENT;
+		
+		gLinkRandom = 0xACE1u ^ gProtocolSetupInfo.address[0];
+		while (!ProtocolConnect(NULL, 0))
+		{
+			__disable_interrupt();
+			while (ProtocolBusy())
+			{
+			  _BIS_SR(LPM0_bits + GIE);
+			  __disable_interrupt();
+			}
+			__enable_interrupt();
+			
+			LinkBackoff(exponent);
+			if (exponent < LINK_BACKOFF_MAX_EXPONENT)
+			{
+				exponent++;
+			}
+		}
+	}
 	#endif
 
 	while (true)
 	{
+		#ifndef Sensor
 		__delay_cycles(700000 * 8 );
+		#else
+		// Sleep for the current sampling period, then stop the watchdog interval
+		// timer until the next period.
+		WatchdogSleep(gSensorPeriod);
 
-		#ifdef Sensor
-		//LastB = ActualB;
-		ActualB = ReadB();
+		ActualB = SensorFilterOversample(&gSensorFilter, ReadB);
 
-		if( abs( ActualB - LastB ) >= 100 )
-			P1OUT = BIT0;
-		else P1OUT = 0;
-
-		if( abs( ActualB - LastB ) >= 200 )
-			P1OUT |= BIT6;
-		else P1OUT = 0;
-
-		int a = (int)ActualB;
-
-		//char *intStr = itoa(a);
-
-		//char buf[12];
-		sprintf((char*)gPacket.payload, "%d\n\r", a);
+		// The baseline is only updated by the detector while it is free. A state
+		// change stays pending until its frame has been handed to the protocol.
+		bool changed = SensorDetectorUpdate(&gSensorDetector, ActualB);
+		if (changed)
+		{
+			gSensorEventPending = true;
+		}
+		LastB = SensorFilterGetBaseline(&gSensorFilter);
 
-		//string str = string(intStr);
+		// Back off while the signal is quiet, sample fast while it moves or the
+		// detector is about to change state.
+		gSensorPeriod = SensorRateUpdate(&gSensorRate, ActualB,
+		                                 changed || SensorDetectorIsPending(&gSensorDetector));
 
-		//unsigned char b = (a - 0) * (255 - 0) / (5000 - 0) + 0;
+		if (SensorDetectorGetState(&gSensorDetector) == eSensorStateOccupied)
+			P1OUT = BIT0;
+		else P1OUT = 0;
 
-		//if( b == 0 ) continue;
+		char text[12];
+		sprintf(text, "%d\n\r", (int)( ActualB - LastB ));
 
 	    TimerA_UART_init();                     // Start Timer_A UART
-	    TimerA_UART_print((char*)gPacket.payload);
+	    TimerA_UART_print(text);
 
-		WDTCTL = WDT_ADLY_16;
-		IE1 |= WDTIE;             // Enable WDT interrupt
-		__enable_interrupt();
-		_BIS_SR(LPM3_bits + GIE); // Enter LPM3 w/interrupt
+		// Nothing to report unless the detector changed state.
+		if (!gSensorEventPending)
+		{
+			continue;
+		}
+		SensorDetectorBuildPayload(&gSensorDetector, gPacket.payload);
 		#endif
 
 		// Perform a simple transfer of the packet.
-		if (!ProtocolSimpleTransfer((unsigned char*)&gPacket, sizeof(struct sPacket)))
+		bool sent = ProtocolSimpleTransfer((unsigned char*)&gPacket, sizeof(struct sPacket));
+		#if defined( PROTOCOL_USE_DUTY_CYCLE )
+		// The duty cycle limiter may hold the frame back. Its tokens are credited
+		// by the watchdog interval timer, which low power mode 4 stops, so wait one
+		// interval at a time in low power mode 3 and try again.
+		while (!sent)
+		{
+		  WatchdogSleep(1);
+		  sent = ProtocolSimpleTransfer((unsigned char*)&gPacket, sizeof(struct sPacket));
+		}
+		#endif
+		if (!sent)
 		{
 		  // Put the microcontroller into a low power state (sleep). Remain here
 		  // until the ISR wakes up the processor.
 		  McuSleep();
 		}
+		#ifdef Sensor
+		else
+		{
+		  gSensorEventPending = false;
+		}
+		#endif
+
+		#if defined( PROTOCOL_USE_CSMA ) || defined( PROTOCOL_USE_ACK ) || defined( PROTOCOL_USE_TDMA )
+		// The frame may still be backing off, waiting for its slot or waiting for
+		// its acknowledgement. Timer1_A runs from SMCLK, so wait in LPM0 until the
+		// frame has been sent or dropped.
+		__disable_interrupt();
+		while (ProtocolBusy())
+		{
+		  _BIS_SR(LPM0_bits + GIE);
+		  __disable_interrupt();
+		}
+		__enable_interrupt();
+		#endif
 
 		/**
 		 *  Check if the protocol is busy. If it is, a new transfer cannot occur
@@ -372,20 +606,6 @@ int main(void)
 #pragma vector=GDO0_VECTOR
 __interrupt void GDO0Isr(void)
 {
-	if( P2IFG & BIT0 )
-	{
-		P2IFG &= ~BIT0;    // clear the interrupt flag
-		// TA0R es el registro que tiene el conteo
-		Time[i] = TA0R;
-		TACTL = 0;
-		TA0R  = 0;
-		TACCTL0 = 0;
-		_BIC_SR(LPM1_EXIT); // wake up from low power mode
-
-		return;
-	}
-
-
   /**
    *  Store the port interrupt flag register so that it may be used to determine
    *  what caused the interrupt (e.g. did a GDO0 interrupt occur? The protocol 
@@ -410,25 +630,97 @@ __interrupt void GDO0Isr(void)
   McuWakeup();
 }
 
-// Note: No hardware timer interrupt required for this example because the 
-// End Point node does not perform half duplex transfers.
+/**
+ *  TimerIsr - Timer1_A CCR0 interrupt service routine. While a discharge is
+ *  being measured CCR0 is in capture mode and holds the cycle-exact time of the
+ *  falling edge on P2.0. Otherwise the interrupt belongs to the protocol timer.
+ *
+ *  Note: The protocol timer schedules the CSMA/CA backoffs, acknowledgement
+ *  windows and TDMA slots.
+ */
+#pragma vector=TIMER1_A0_VECTOR
+__interrupt void TimerIsr(void)
+{
+	if (TA1CCTL0 & CAP)
+	{
+		TA1CCTL0 = 0;
+#if defined( SENSOR_PARALLEL_CAPTURE )
+		if (!SenseCapture(0, TA1CCR0))
+		{
+			return;
+		}
+#else
+		Time[i] = TA1CCR0;
+		gCapturePending = 0;
+#endif
+		TA1CTL = MC_0;
+		_BIC_SR(LPM1_EXIT); // wake up from low power mode
+
+		return;
+	}
+
+	// Notify the protocol of a timer tick.
+	ProtocolEngineTick();
+
+	// Wake up the microcontroller to continue normal operation upon exiting the
+	// ISR.
+	McuWakeup();
+}
+
+/**
+ *  TimerCaptureIsr - Timer1_A CCR1/CCR2 and overflow interrupt service routine.
+ *  Stores the discharge times of the second and third electrodes in parallel
+ *  capture mode. The overflow ends a capture sequence that missed an edge.
+ */
+#pragma vector=TIMER1_A1_VECTOR
+__interrupt void TimerCaptureIsr(void)
+{
+	bool complete = false;
 
+	switch (__even_in_range(TA1IV, TA1IV_TAIFG))
+	{
+#if defined( SENSOR_PARALLEL_CAPTURE )
+	case TA1IV_TACCR1:
+		TA1CCTL1 = 0;
+		complete = SenseCapture(1, TA1CCR1);
+		break;
+	case TA1IV_TACCR2:
+		TA1CCTL2 = 0;
+		complete = SenseCapture(2, TA1CCR2);
+		break;
+#endif
+	case TA1IV_TAIFG:
+		SenseTimeout();
+		complete = true;
+		break;
+	}
 
+	if (complete)
+	{
+		TA1CTL = MC_0;
+		_BIC_SR(LPM1_EXIT); // wake up from low power mode
+	}
+}
 
 // Watchdog Timer interrupt service routine
 #pragma vector=WDT_VECTOR
 __interrupt void watchdog_timer(void)
 {
-	// 16ms * 125 = 4 seg
-	if(wdtCounter == 124 / 10 )
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+	// Credit the duty cycle limiter with the time slept (15.6ms per interval,
+	// rounded down). The protocol counts its own time while it is busy.
+	if (!ProtocolBusy())
+	{
+		ProtocolEngineElapsed(15);
+	}
+#endif
+
+	// 16ms per interval; wake up once the requested intervals have elapsed.
+	if( ++wdtCounter >= gWatchdogIntervals )
 	{
-		//P1OUT ^= 0x01;                            // Toggle P1.0 using exclusive-OR
-		//P1OUT = 0x00; // P1.0 turn off
 		wdtCounter = 0;
-		//_BIS_SR(LPM4_bits + GIE); // Enter LPM3 w/interrupt
 		_BIC_SR(LPM3_EXIT); // wake up from low power mode
 	}
-	else ++wdtCounter;
 }
 
 /*#pragma vector=TIMER0_A0_VECTOR
@@ -71,15 +71,32 @@
 #define RF_SPI_CSN_3                    // Default CSn position
 #define RF_GDO0_2                       // Default GDO0 position
 #define TIMER1_A                        // Protocol uses Timer1_A3
+//#define RF_SPI_USE_ISR                  // SPI bursts of 8+ bytes run from the USCIB0 interrupt in LPM0 (pays off with RF_SPI_CLOCK_DIVIDER > 2)
+#define CC1101_STATIC_HAL A110x2500     // Call the platform SPI/GDOx functions directly (undefine for the host emulator)
     
 // -----------------------------------------------------------------------------
 /**
  *  Physical radio characteristics
  */
 
-#define A110LR09_FCC_2FSK_1_2_KBAUD       // Configuration => 2FSK, 1.2kBaud, 902MHz
+#define A110LR09_FCC_2FSK_1_2_KBAUD       // Configuration => 2FSK, 1.2kBaud, 902MHz (base profile)
+//#define A110LR09_FCC_2FSK_38_KBAUD      // Configuration => 2FSK, 38kBaud, 902MHz (PROTOCOL_USE_ADR)
+//#define A110LR09_FCC_2FSK_100_KBAUD     // Configuration => 2FSK, 100kBaud, 902MHz (PROTOCOL_USE_ADR)
+//#define A110LR09_FCC_2FSK_250_KBAUD     // Configuration => 2FSK, 250kBaud, 902MHz (PROTOCOL_USE_ADR)
 #define A110LR09_POWER_7_0_DBM            // Power table setting => 7.0dBm
+//#define A110LR09_POWER_4_0_DBM          // Power table setting => 4.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_0_0_DBM          // Power table setting => 0.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_5_0_DBM      // Power table setting => -5.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_10_0_DBM     // Power table setting => -10.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_15_0_DBM     // Power table setting => -15.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_20_0_DBM     // Power table setting => -20.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_30_0_DBM     // Power table setting => -30.0dBm (PROTOCOL_USE_TPC)
+//#define CC1101_REGISTER_SHADOW          // Serve configuration register reads from RAM (48 bytes)
+//#define A110LR09_WARM_START             // Reuse the radio configuration across a processor reset (needs CC1101_REGISTER_SHADOW)
 #define PHY_MAX_TXFIFO_SIZE         64    // Physical hardware absolute FIFO size
+//#define PHY_USE_FIFO_STREAMING            // Refill/drain the FIFOs on the GDO2 threshold (data streams up to 255 bytes)
+//#define PHY_MAX_DATASTREAM_SIZE     255   // Largest streamed data stream (the frame buffer must hold it)
+//#define RF_GDO2_1                       // GDO2 position (PHY_USE_FIFO_STREAMING; its port ISR must call ProtocolEngine)
 
 // -----------------------------------------------------------------------------
 /**
@@ -87,10 +104,58 @@
  */
 
 #define PROTOCOL_ENDPOINT                       // Node role
-#define PROTOCOL_CHANNEL_LIST               0   // Physical channel list (comma seperated)
+#define PROTOCOL_CHANNEL_LIST               0   // Physical channel list (comma seperated; control channel first)
 #define PROTOCOL_CHANNEL_LIST_SIZE          1   // Physical channel list size
 #define PROTOCOL_PHYADDRESS_PANID_SIZE      1   // Physical address PAN identifier size
 #define PROTOCOL_PHYADDRESS_ADDRESS_SIZE    1   // Physical address size
-#define PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH  10   // Maximum frame payload length
+#define PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH  11   // Maximum frame payload length (sizeof(struct sPacket); 15 with PROTOCOL_USE_TPC)
+//#define PROTOCOL_USE_CSMA                       // Listen before talk with random backoff (~14 bytes RAM)
+//#define PROTOCOL_CSMA_MIN_BE                3   // Initial backoff exponent
+//#define PROTOCOL_CSMA_MAX_BE                5   // Largest backoff exponent
+//#define PROTOCOL_CSMA_MAX_BACKOFFS          4   // Busy channel assessments before dropping
+//#define PROTOCOL_CSMA_BACKOFF_PERIOD        10  // Backoff period (1ms timer ticks)
+//#define PROTOCOL_USE_ACK                        // Request an acknowledgement for data frames (~20 bytes RAM)
+//#define PROTOCOL_ACK_MAX_RETRIES            3   // Retransmissions before dropping
+//#define PROTOCOL_ACK_TURNAROUND             20  // Gateway turnaround allowance (1ms timer ticks)
+//#define PROTOCOL_ACK_BACKOFF_PERIOD         10  // Retry backoff period (1ms timer ticks)
+//#define PROTOCOL_USE_TDMA                       // Send data frames in the slot assigned by the Gateway (~26 bytes RAM)
+//#define PROTOCOL_TDMA_SLOTS                 8   // Transmit slots per superframe
+//#define PROTOCOL_TDMA_SLOT_LENGTH           350 // Slot length (1ms timer ticks)
+//#define PROTOCOL_TDMA_GUARD                 10  // Guard time at the start of a slot (1ms timer ticks)
+//#define PROTOCOL_USE_GROUP_ACK                  // Acknowledgements of slot frames are carried by the next beacon
+//#define PROTOCOL_USE_CHANNEL_AGILITY            // Serve the transmit slots on the data channels of the channel list (~8 bytes RAM; 2+ channels)
+//#define PROTOCOL_USE_ADR                        // Serve each transmit slot with the fastest profile its RSSI supports (~6 bytes RAM)
+//#define PROTOCOL_ADR_PROFILES               4   // Physical configurations (slowest first)
+//#define PROTOCOL_ADR_SENSITIVITY            -111, -102, -97, -90 // Typical sensitivity of each configuration (dBm)
+//#define PROTOCOL_ADR_MARGIN                 10  // RSSI required above the sensitivity (dB)
+//#define PROTOCOL_USE_TPC                        // Step the slot output power down to the link margin (~8 bytes RAM)
+//#define PROTOCOL_TPC_MARGIN                 10  // RSSI kept above the sensitivity (dB)
+//#define PROTOCOL_TPC_HYSTERESIS             4   // Headroom before lowering the output power (dB)
+//#define PROTOCOL_USE_DUTY_CYCLE                 // Hold frames back at the duty cycle of the configuration (ETSI) (~6 bytes RAM)
+//#define PROTOCOL_DUTY_CYCLE_WINDOW          3600 // Duty cycle observation window (seconds)
+//#define PROTOCOL_DUTY_CYCLE_BURST           3   // Burst share of the window airtime (2^-n)
+//#define PROTOCOL_USE_FRAGMENTATION              // Send data messages longer than one frame as fragments (~6 bytes RAM)
+//#define PROTOCOL_FRAGMENT_BUFFERS           2   // Gateway reassembly buffers
+//#define PROTOCOL_FRAGMENT_MAX_LENGTH        48  // Longest reassembled message (bytes)
+#define PROTOCOL_FRAME_HEADER_LAYOUT        1   // On-air frame header layout (2 with PROTOCOL_USE_DESTINATION_FILTER; End Point and Gateway must match)
+//#define PROTOCOL_USE_DESTINATION_FILTER         // Lead frames with the destination address and filter it in hardware (changes the on-air frame header)
+// -----------------------------------------------------------------------------
+/**
+ *  Sensor characteristics
+ */
+
+//#define SENSOR_PARALLEL_CAPTURE                 // Charge once, capture the three electrodes at once
+#define SENSOR_FILTER_OVERSAMPLE            8   // Maximum raw readings per filtered reading
+#define SENSOR_FILTER_MEDIAN_SIZE           3   // Minimum raw readings before early termination
+#define SENSOR_FILTER_EARLY_STOP_SPREAD     32  // Reading spread that allows early termination
+#define SENSOR_FILTER_BASELINE_SHIFT        4   // Baseline IIR coefficient (1 / 2^shift)
+#define SENSOR_DETECTOR_ENTER_THRESHOLD     100 // Baseline deviation that enters occupied
+#define SENSOR_DETECTOR_EXIT_THRESHOLD      50  // Baseline deviation that returns to free
+#define SENSOR_DETECTOR_DEBOUNCE            2   // Readings required to confirm a change
+#define SENSOR_RATE_MIN_PERIOD              13  // Fast sampling period (16ms intervals)
+#define SENSOR_RATE_MAX_PERIOD              512 // Slowest sampling period (16ms intervals)
+#define SENSOR_RATE_BACKOFF_FACTOR          2   // Period multiplier while the signal is quiet
+#define SENSOR_RATE_VARIANCE_THRESHOLD      400 // Reading variance that snaps to the fast period
+#define SENSOR_RATE_VARIANCE_SHIFT          2   // Variance IIR coefficient (1 / 2^shift)
 
 #endif  /* SIMPLEX_TRANSFER_LR09_CONFIG_H */
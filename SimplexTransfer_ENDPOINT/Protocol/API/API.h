@@ -58,10 +58,27 @@
 #define PROTOCOL_PHYSICAL_STATUS_CRC    (0x0080u)
 #define PROTOCOL_PHYSICAL_STATUS_LQI    (0x007Fu)
 
+/**
+ *  PROTOCOL_USE_TIMER - the protocol timer runs while the protocol is idle. An
+ *  End Point schedules backoffs, acknowledgement windows and slots on it. A
+ *  Gateway schedules its beacons and ages its reassembly buffers. The 
+ *  application must serve ProtocolEngineTick and keep the timer clock running
+ *  while it sleeps.
+ */
+#if (defined( PROTOCOL_ENDPOINT ) && (defined( PROTOCOL_USE_CSMA ) || defined( PROTOCOL_USE_ACK ))) \
+    || defined( PROTOCOL_USE_TDMA ) \
+    || (defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_FRAGMENTATION ))
+#define PROTOCOL_USE_TIMER
+#endif
+
 #if defined( PROTOCOL_ENDPOINT )    
 /**
  *  sProtocolSetupInfo - setup information used to initialize the protocol. For
  *  an End Point node, { channel, panId, address } are required parameters.
+ *
+ *  Only the first channel is used unless PROTOCOL_USE_CHANNEL_AGILITY is
+ *  defined. The first channel is then the control channel and the remaining
+ *  channels carry the transmit slots.
  */
 struct sProtocolSetupInfo
 {
@@ -114,6 +131,10 @@ struct sProtocolSetupInfo
 /**
  *  sProtocolSetupInfo - setup information used to initialize the protocol. For
  *  a Gateway node, { channel, panId, address } are required parameters.
+ *
+ *  Only the first channel is used unless PROTOCOL_USE_CHANNEL_AGILITY is
+ *  defined. The first channel is then the control channel and the remaining
+ *  channels carry the transmit slots.
  */
 struct sProtocolSetupInfo
 {
@@ -133,7 +154,9 @@ struct sProtocolSetupInfo
   bool(*LinkRequest)(unsigned char *payload, unsigned char length);
   /**
    *  TransferComplete - notification of a transfer complete event. Allows the
-   *  application to read an incoming message and act on it.
+   *  application to read an incoming message and act on it. With 
+   *  PROTOCOL_USE_FRAGMENTATION a fragmented message is notified once all of
+   *  its fragments have been received.
    *
    *    @param  dataRequest Data requested indicator.
    *    @param  payload     Data being received.
@@ -260,6 +283,25 @@ const struct sProtocolPhysicalInfo* ProtocolStatusPhysicalInfo(void);
  */
 bool ProtocolBusy(void);
 
+/**
+ *  ProtocolChannelSurvey - measure the energy on every channel approved for
+ *  the radio configuration and rank the quietest channels. Reception is 
+ *  suspended and the protocol timer is held during the survey (about one 
+ *  millisecond per channel).
+ *
+ *  Note: On an End Point, the survey is only performed while the protocol is
+ *  not busy.
+ *
+ *    @param  channel Ranked channels, quietest first.
+ *    @param  power   Absolute power level (dBm) measured on each ranked channel.
+ *    @param  count   Number of entries available in channel and power.
+ *
+ *    @return Number of ranked channels (at most count).
+ */
+unsigned char ProtocolChannelSurvey(unsigned char *channel, 
+                                    signed int *power, 
+                                    unsigned char count);
+
 // -----------------------------------------------------------------------------
 // Protocol operations
 
@@ -269,6 +311,10 @@ bool ProtocolBusy(void);
  *  Note: This function is only applicable to nodes that perform two-way 
  *  communication and may only be called on an End Point node.
  *
+ *  Note: With PROTOCOL_USE_TDMA the Gateway assigns a transmit slot to the End
+ *  Point. The End Point is not connected until it owns a slot; data frames 
+ *  sent before are sent with contention access.
+ *
  *    @param  txData      Data to be transferred during the connection attempt.
  *    @param  txLength    Number of data bytes to transfer.
  *
@@ -291,6 +337,10 @@ void ProtocolDisconnect(void);
  *
  *  Note: This function is only supported by End Point nodes!
  *
+ *  Note: With PROTOCOL_USE_FRAGMENTATION a message longer than one frame is
+ *  sent as several frames. The data must not change until the transfer 
+ *  completes (see ProtocolBusy).
+ *
  *    @param  txData      Data to be transferred.
  *    @param  txLength    Number of data bytes to transfer.
  *
@@ -307,6 +357,10 @@ bool ProtocolSimpleTransfer(const unsigned char *txData, unsigned char length);
  *  will not be transferred until a connection exists. Be sure to ALWAYS call 
  *  Connect before attempting to use this function.
  *
+ *  Note: With PROTOCOL_USE_FRAGMENTATION a message longer than one frame is
+ *  sent as several frames. The data must not change until the transfer 
+ *  completes (see ProtocolBusy).
+ *
  *    @param  txData      Data to be transferred.
  *    @param  txLength    Number of data bytes to transfer.
  *
@@ -354,4 +408,16 @@ unsigned char ProtocolEngine(volatile unsigned char event);
  */
 void ProtocolEngineTick(void);
 
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+/**
+ *  ProtocolEngineElapsed - credit the duty cycle limiter with time that has
+ *  elapsed while the protocol timer was stopped (e.g. while sleeping between
+ *  transfers). Time elapsed while the protocol is busy is already counted by
+ *  ProtocolEngineTick and must not be credited again.
+ *
+ *    @param  elapsed   Elapsed time (milliseconds).
+ */
+void ProtocolEngineElapsed(unsigned int elapsed);
+#endif
+
 #endif  /* API_H */
@@ -10,8 +10,8 @@
  *  Frame.c - Data Link layer Media Access Control (MAC) framing and scheduling 
  *  sub layer.
  *
- *  @version    1.0.01
- *  @date       17 Sep 2012
+ *  @version    1.0.02
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  For details on the interface, please see Frame.h.
@@ -22,11 +22,40 @@
  *
  *  file dependency
  *  ===============
- *  string.h : defines the functions "memcpy" that is used for copying addresses
+ *  string.h : defines the functions "memcpy" and "memset" that are used for
+ *  copying addresses
  *  Frame.h : provides interface function prototypes and global definitions
  *
  *  revision history
  *  ================
+ *  ver 1.0.02 : 19 Oct 2026
+ *  - End Points may send frames using CSMA/CA: the frame is deferred by a
+ *  random binary exponential backoff and only sent on a clear channel; the
+ *  receiver is turned on when the backoff expires and the channel is assessed
+ *  once it has settled
+ *  - End Point data frames may request an acknowledgement; the Gateway
+ *  acknowledges immediately and the End Point retransmits on a missed
+ *  acknowledgement window
+ *  - a Gateway may broadcast a beacon with a TDMA slot map; linked End Points
+ *  send their data frames in the slot assigned when they linked
+ *  - the Gateway may acknowledge the frames sent in the slots of a superframe
+ *  with a single ack map in the next beacon (group acknowledgement)
+ *  - slots may be spread over the data channels of the channel list; the
+ *  Gateway hops to the channel of each slot and blocks data channels with
+ *  repeated reception errors or high energy; the periodic energy survey 
+ *  measures one channel per beacon
+ *  - added the channel energy survey (FrameChannelSurvey)
+ *  - each slot may be served with its own physical configuration; the Gateway
+ *  selects the fastest one the RSSI of the slot supports (adaptive data rate)
+ *  - the Gateway reports the headroom of each slot in the beacon; End Points
+ *  step the output power of their slot down to the lowest power keeping the
+ *  link margin (transmit power control)
+ *  - FrameSend may be limited by a token bucket refilled at the duty cycle of
+ *  the configuration (PROTOCOL_USE_DUTY_CYCLE)
+ *  - End Point data messages longer than one frame are sent as fragments; the
+ *  Gateway reassembles them per source and passes up complete messages
+ *  - added FrameFilter; frames for another node or PAN are rejected once 
+ *  their header is received
  *  ver 1.0.01 : 16 Oct 2012
  *  - updated internal documentation; comments revised
  *  - added a test example (stub) to perform various frame operations
@@ -48,6 +77,13 @@
 
 static struct sFrameScheduler gFrameScheduler;  // MAC scheduler information
 
+#if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_ADR )
+// Receiver sensitivity of each profile (dBm)
+static const signed char gFrameAdrSensitivity[PROTOCOL_ADR_PROFILES] = {
+  PROTOCOL_ADR_SENSITIVITY
+};
+#endif
+
 // -----------------------------------------------------------------------------
 /**
  *  Private interface
@@ -62,6 +98,7 @@ void FrameBuild(enum eFrameType type,
                 unsigned char length)
 {
   static unsigned char seqNumber = 0;
+  unsigned char offset = 0;
 
   // Update frame destination and source.
   PhyAddressCopy(gFrameScheduler.frame.header.panId,
@@ -90,6 +127,29 @@ void FrameBuild(enum eFrameType type,
   {
     gFrameScheduler.frame.header.control |= FRAME_CONTROL_DATA_REQ;
   }
+  gFrameScheduler.frame.header.control &= ~(FRAME_CONTROL_ACK_REQ | FRAME_CONTROL_ACK);
+  gFrameScheduler.frame.header.control &= ~FRAME_CONTROL_PENDING;
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_FRAGMENTATION )
+  // Data frames start with the fragment header. All fragments of a message but
+  // the last one are pending.
+  if (type == eFrameTypeData)
+  {
+    gFrameScheduler.frame.payload[0] = gFrameScheduler.fragment.index;
+    offset = FRAME_FRAGMENT_HEADER_LENGTH;
+    if (gFrameScheduler.fragment.remaining > 0)
+    {
+      gFrameScheduler.frame.header.control |= FRAME_CONTROL_PENDING;
+    }
+  }
+  #endif
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+  // Simplex data frames are acknowledged by the Gateway. A data request is
+  // answered by a data response instead.
+  if (type == eFrameTypeData && !dataRequest)
+  {
+    gFrameScheduler.frame.header.control |= FRAME_CONTROL_ACK_REQ;
+  }
+  #endif
   #if defined( PROTOCOL_ENDPOINT )
   gFrameScheduler.frame.header.control &= ~FRAME_CONTROL_MODE;
   #elif defined( PROTOCOL_GATEWAY )
@@ -98,8 +158,21 @@ void FrameBuild(enum eFrameType type,
   gFrameScheduler.frame.header.seqNumber = seqNumber++;
     
   // Copy the payload into the internal frame buffer.
-  gFrameScheduler.length = length;
-  memcpy(&gFrameScheduler.frame.payload, payload, length);
+  gFrameScheduler.length = offset + length;
+  memcpy(&gFrameScheduler.frame.payload[offset], payload, length);
+  
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+  // Keep a copy of the frame for retransmissions.
+  gFrameScheduler.ack.waiting = false;
+  gFrameScheduler.ack.retries = 0;
+  if (gFrameScheduler.frame.header.control & FRAME_CONTROL_ACK_REQ)
+  {
+    gFrameScheduler.ack.length = gFrameScheduler.length;
+    memcpy(&gFrameScheduler.ack.frame, 
+           &gFrameScheduler.frame, 
+           gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  }
+  #endif
 }
 
 /**
@@ -129,7 +202,16 @@ bool FrameEndPointValidate(unsigned char destPan[PHY_ADDRESS_PANID_SIZE],
   // Verify destination address.
   if (PhyAddressCompare(local->address, destAddr, PHY_ADDRESS_ADDRESS_SIZE) != 0)
   {
+    #if defined( PROTOCOL_USE_TDMA )
+    // Beacons are sent to the broadcast address.
+    if ((gFrameScheduler.frame.header.control & FRAME_CONTROL_TYPE) != eFrameTypeBeacon
+        || !PhyAddressIsBroadcast(destAddr, PHY_ADDRESS_ADDRESS_SIZE))
+    {
+      return false;
+    }
+    #else
     return false;
+    #endif
   }
   
   // Verify PAN identifier.
@@ -215,115 +297,2123 @@ bool FrameGatewayValidate(unsigned char destPan[PHY_ADDRESS_PANID_SIZE],
 #endif
 
 // -----------------------------------------------------------------------------
-// Frame scheduler operations
+// Frame timer
 
+#if defined( FRAME_USE_TIMER )
 /**
- *  FrameSchedulerData - scheduler operation to process all incoming data
- *  frames.
+ *  FrameRandom - get the next value of the backoff pseudo-random sequence
+ *  (16-bit Galois LFSR, x^16 + x^14 + x^13 + x^11 + 1).
  *
- *    @return Status message from callee (currently not being used for frame 
- *            use).
+ *    @return Pseudo-random value.
  */
-unsigned char FrameSchedulerData(void)
-{ 
-  // Pass the payload (without frame header and footer) up to the next layer.
-  if (gFrameScheduler.FrameComplete != NULL)
+unsigned int FrameRandom()
+{
+  unsigned int lfsr = gFrameScheduler.timer.random;
+  
+  lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+  gFrameScheduler.timer.random = lfsr;
+  
+  return lfsr;
+}
+
+/**
+ *  FrameTimerStart - start the frame timer.
+ *
+ *    @param  event   Operation performed when the timer expires.
+ *    @param  delay   Time until expiry (timer ticks). Must not be zero.
+ */
+void FrameTimerStart(enum eFrameTimerEvent event, unsigned int delay)
+{
+  gFrameScheduler.timer.event = event;
+  gFrameScheduler.timer.delay = delay;
+  PhyTimerStart();
+}
+
+/**
+ *  FrameTimerStop - stop the frame timer.
+ */
+void FrameTimerStop()
+{
+  PhyTimerStop();
+  gFrameScheduler.timer.delay = 0;
+  gFrameScheduler.timer.event = eFrameTimerIdle;
+}
+
+/**
+ *  FrameBackoff - start a random backoff of 0 to 2^exponent - 1 periods. The
+ *  timer expires one tick after the delay so that the frame is always sent from
+ *  the timer context.
+ *
+ *    @param  exponent  Backoff exponent.
+ *    @param  period    Length of one backoff period (timer ticks).
+ */
+void FrameBackoff(unsigned char exponent, unsigned int period)
+{
+  unsigned int periods = FrameRandom() & ((1u << exponent) - 1);
+  
+  FrameTimerStart(eFrameTimerBackoff, (periods * period) + 1);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Duty cycle
+
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+/**
+ *  FrameDutyCycleCost - get the tokens drawn by a frame.
+ *
+ *    @param  length  Number of bytes in the frame (with header and footer).
+ *
+ *    @return Tokens drawn from the bucket. Zero if the configuration has no 
+ *            duty cycle requirement.
+ */
+signed long FrameDutyCycleCost(unsigned char length)
+{
+  if (PhyGetDutyCycle() >= PHY_DUTY_CYCLE_UNRESTRICTED)
   {
-    #if defined( PROTOCOL_GATEWAY )
-    bool dataRequest = (gFrameScheduler.frame.header.control & FRAME_CONTROL_DATA_REQ) >> 1;
-    #endif
-    unsigned char statusMessage = 0;
-    
-    gFrameScheduler.frame.header.control &= ~FRAME_CONTROL_DATA_REQ;
-    
-    #if defined( PROTOCOL_ENDPOINT )
-    statusMessage = gFrameScheduler.FrameComplete(gFrameScheduler.frame.payload, 
-                                                  gFrameScheduler.length);
-    #elif defined( PROTOCOL_GATEWAY )
-    statusMessage = gFrameScheduler.FrameComplete(dataRequest,
-                                                  gFrameScheduler.frame.payload, 
-                                                  gFrameScheduler.length);
-    #endif
+    return 0;
+  }
+  
+  return (signed long)PhyGetAirtime(length) * (1000L << PROTOCOL_DUTY_CYCLE_BURST);
+}
+
+/**
+ *  FrameDutyCycleCapacity - get the size of the bucket.
+ *
+ *    @return Tokens held by a full bucket.
+ */
+signed long FrameDutyCycleCapacity()
+{
+  unsigned long capacity = (unsigned long)PhyGetDutyCycle() * (PROTOCOL_DUTY_CYCLE_WINDOW * 1000UL);
+  
+  if (capacity > 0x7FFFFFFFUL)
+  {
+    capacity = 0x7FFFFFFFUL;
+  }
+  
+  return (signed long)capacity;
+}
+
+/**
+ *  FrameDutyCycleCredit - refill the bucket with elapsed time.
+ *
+ *    @param  elapsed   Elapsed time (milliseconds).
+ */
+void FrameDutyCycleCredit(unsigned int elapsed)
+{
+  unsigned int duty = PhyGetDutyCycle();
+  unsigned long rate = (unsigned long)duty * ((1u << PROTOCOL_DUTY_CYCLE_BURST) - 1);
+  signed long capacity = FrameDutyCycleCapacity();
+  unsigned int step;
+  
+  if (duty >= PHY_DUTY_CYCLE_UNRESTRICTED)
+  {
+    return;
+  }
+  
+  // Credit in steps short enough for the product to fit in 32 bits.
+  while (elapsed > 0)
+  {
+    step = (elapsed > 0x3FFFu) ? 0x3FFFu : elapsed;
+    elapsed -= step;
     
-    #if defined( PROTOCOL_GATEWAY )
-    // Send data back to the requesting node, if required.
-    if (dataRequest && (gFrameScheduler.dataResponse.length > 0))
+    if (gFrameScheduler.duty.tokens >= capacity
+        || (unsigned long)(capacity - gFrameScheduler.duty.tokens) <= rate * step)
     {
-      // Send a data response.
-      PhyEnable();
-      FrameSend(eFrameTypeData, 
-                dataRequest, 
-                gFrameScheduler.dataResponse.payload, 
-                gFrameScheduler.dataResponse.length);
+      gFrameScheduler.duty.tokens = capacity;
+      return;
     }
+    gFrameScheduler.duty.tokens += (signed long)(rate * step);
+  }
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Channel access
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+/**
+ *  FrameCsmaBackoff - start a random backoff with the current backoff exponent 
+ *  (BE).
+ */
+void FrameCsmaBackoff()
+{
+  FrameBackoff(gFrameScheduler.csma.exponent, PROTOCOL_CSMA_BACKOFF_PERIOD);
+}
+
+/**
+ *  FrameCsmaListen - the backoff has expired. Turn on the receiver and assess
+ *  the channel once it has settled (see FrameCsmaAttempt).
+ */
+void FrameCsmaListen()
+{
+  PhyListen();
+  FrameTimerStart(eFrameTimerCca, PROTOCOL_CSMA_LISTEN_DELAY);
+}
+
+/**
+ *  FrameCsmaAttempt - try to send the pending frame. The physical layer only
+ *  transmits if the clear channel assessment reports an idle channel. On a busy
+ *  channel the backoff exponent is increased (up to PROTOCOL_CSMA_MAX_BE) and a
+ *  new backoff is started. The frame is dropped once more than
+ *  PROTOCOL_CSMA_MAX_BACKOFFS busy channel assessments have occurred.
+ */
+void FrameCsmaAttempt()
+{
+  if (PhyTransmit((unsigned char*)&gFrameScheduler.frame,
+                  gFrameScheduler.length + FRAME_OVERHEAD_LENGTH))
+  {
+    return;
+  }
+  
+  gFrameScheduler.csma.busyCount++;
+  
+  if (++gFrameScheduler.csma.backoffs > PROTOCOL_CSMA_MAX_BACKOFFS)
+  {
+    // Error: channel access failure. Drop the frame.
+    gFrameScheduler.csma.failures++;
+    #if defined( PROTOCOL_USE_ACK )
+    gFrameScheduler.ack.waiting = false;
     #endif
+    gFrameScheduler.length = 0;
+    gFrameScheduler.busy = false;
+    FrameIdle();
+    return;
+  }
+  
+  if (gFrameScheduler.csma.exponent < PROTOCOL_CSMA_MAX_BE)
+  {
+    gFrameScheduler.csma.exponent++;
+  }
+  
+  // Do not keep the receiver on while backing off.
+  FrameIdle();
+  FrameCsmaBackoff();
+}
+#endif
 
-    // Return user callback status message.
-    return statusMessage;
+// -----------------------------------------------------------------------------
+// Channel agility
+
+#if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+/**
+ *  FrameChannelForSlot - get the data channel of a transmit slot. If every
+ *  data channel is blocked, the mask is ignored.
+ *
+ *    @param  slot      Transmit slot.
+ *    @param  blocked   Blocked data channels.
+ *
+ *    @return Channel list index of the data channel.
+ */
+unsigned char FrameChannelForSlot(unsigned char slot, unsigned char blocked)
+{
+  unsigned char usable = ~blocked & FRAME_CHANNEL_DATA_MASK;
+  unsigned char count = 0;
+  unsigned char index;
+  
+  if (usable == 0)
+  {
+    usable = FRAME_CHANNEL_DATA_MASK;
   }
   
-  return 0;
+  for (index = 0; index < FRAME_CHANNEL_DATA_COUNT; index++)
+  {
+    if (usable & (1u << index))
+    {
+      count++;
+    }
+  }
+  
+  // Select the (slot % count)th usable data channel.
+  slot %= count;
+  for (index = 0; index < FRAME_CHANNEL_DATA_COUNT; index++)
+  {
+    if ((usable & (1u << index)) && slot-- == 0)
+    {
+      break;
+    }
+  }
+  
+  return index + 1;
 }
 
 /**
- *  FrameSchedulerLinkRequest - scheduler operation to process all incoming link 
- *  requests.
+ *  FrameChannelTune - tune the radio to a channel of the channel list. The 
+ *  radio is left active; the caller selects the next operation.
  *
- *    @return Status message from callee (currently not being used for frame 
- *            use).
+ *    @param  index   Channel list index.
  */
-unsigned char FrameSchedulerLinkRequest(void)
+void FrameChannelTune(unsigned char index)
 {
-  #if defined( PROTOCOL_ENDPOINT )
-  // An End Point will receive a link request response if the link request was
-  // approved.
-  PhyAddressLinkEstablish(gFrameScheduler.frame.header.panId,
-                          gFrameScheduler.frame.header.srcAddr);
-  #elif defined( PROTOCOL_GATEWAY )
-  if ((gFrameScheduler.frame.header.control & FRAME_CONTROL_MODE) == FRAME_CONTROL_MODE_ENDPOINT)
+  if (index != gFrameScheduler.channel.current)
   {
-    bool accept = true;     // Default behavior: accept all incoming requests
-    
-    // A Gateway node will verify the link request and send a link request 
-    // response if the link request has been approved.
-    if (gFrameScheduler.LinkRequest != NULL)
+    gFrameScheduler.channel.current = index;
+    PhySetChannel(gFrameScheduler.channel.list[index]);
+  }
+}
+
+#if defined( PROTOCOL_GATEWAY )
+/**
+ *  FrameChannelReport - account for a reception on the current channel. A 
+ *  data channel that reaches PROTOCOL_CHANNEL_ERROR_LIMIT reception errors
+ *  is blocked from the next beacon on. The last usable data channel is never
+ *  blocked.
+ *
+ *    @param  error   Set if the reception has failed (CRC, length or a frame
+ *                    from another network), clear for a valid frame.
+ */
+void FrameChannelReport(bool error)
+{
+  unsigned char data = gFrameScheduler.channel.current;
+  unsigned char mask;
+  
+  // The control channel is never blocked.
+  if (data == FRAME_CHANNEL_CONTROL)
+  {
+    return;
+  }
+  data--;
+  
+  if (!error)
+  {
+    if (gFrameScheduler.channel.errors[data] > 0)
     {
-      accept = gFrameScheduler.LinkRequest(gFrameScheduler.frame.payload, 
-                                           gFrameScheduler.length);
+      gFrameScheduler.channel.errors[data]--;
+    }
+    return;
+  }
+  
+  if (++gFrameScheduler.channel.errors[data] < PROTOCOL_CHANNEL_ERROR_LIMIT)
+  {
+    return;
+  }
+  
+  gFrameScheduler.channel.errors[data] = 0;
+  mask = (unsigned char)(1u << data);
+  if (!(gFrameScheduler.channel.pending & mask)
+      && (gFrameScheduler.channel.pending | mask) != FRAME_CHANNEL_DATA_MASK)
+  {
+    gFrameScheduler.channel.pending |= mask;
+    gFrameScheduler.channel.age = 0;
+    gFrameScheduler.channel.migrations++;
+  }
+}
+
+/**
+ *  FrameChannelMeasure - measure the energy on a channel of the channel list. 
+ *  The radio is tuned back to the current channel and left in an idle state.
+ *
+ *    @param  index   Channel list index.
+ */
+void FrameChannelMeasure(unsigned char index)
+{
+  PhySetChannel(gFrameScheduler.channel.list[index]);
+  gFrameScheduler.channel.energy[index] = PhyGetInstantSignalStrength();
+  PhySetChannel(gFrameScheduler.channel.list[gFrameScheduler.channel.current]);
+}
+
+/**
+ *  FrameChannelBlock - block the data channels that are 
+ *  PROTOCOL_CHANNEL_ENERGY_MARGIN above the quietest data channel of the last 
+ *  energy survey from the next beacon on.
+ */
+void FrameChannelBlock()
+{
+  tPower quietest = 0x7FFF;
+  unsigned char index;
+  
+  for (index = 1; index < PROTOCOL_CHANNEL_LIST_SIZE; index++)
+  {
+    if (gFrameScheduler.channel.energy[index] < quietest)
+    {
+      quietest = gFrameScheduler.channel.energy[index];
     }
+  }
+  
+  for (index = 1; index < PROTOCOL_CHANNEL_LIST_SIZE; index++)
+  {
+    unsigned char mask = (unsigned char)(1u << (index - 1));
     
-    if (accept)
+    if (gFrameScheduler.channel.energy[index] > quietest + PROTOCOL_CHANNEL_ENERGY_MARGIN
+        && !(gFrameScheduler.channel.pending & mask)
+        && (gFrameScheduler.channel.pending | mask) != FRAME_CHANNEL_DATA_MASK)
     {
-      // The link request has been accepted. Provide a response to the remote
-      // node.
-      PhyEnable();
-      FrameSend(eFrameTypeLinkRequest, false, NULL, 0);
+      gFrameScheduler.channel.pending |= mask;
+      gFrameScheduler.channel.age = 0;
+      gFrameScheduler.channel.migrations++;
     }
   }
-  #endif
+}
 
-  return 0;
+/**
+ *  FrameChannelAssess - measure the energy on each channel of the channel 
+ *  list and block the data channels with high energy (see FrameChannelBlock).
+ *  The radio is tuned back to the current channel and left in an idle state.
+ */
+void FrameChannelAssess()
+{
+  unsigned char index;
+  
+  for (index = 0; index < PROTOCOL_CHANNEL_LIST_SIZE; index++)
+  {
+    FrameChannelMeasure(index);
+  }
+  FrameChannelBlock();
 }
+#endif
+#endif
 
 // -----------------------------------------------------------------------------
+// Adaptive data rate
+
+#if defined( PROTOCOL_USE_ADR )
 /**
- *  Public interface
+ *  FrameAdrSelect - configure the radio with a profile. The channel and the 
+ *  address filter are kept; the radio is left in an idle state if the profile
+ *  changes.
+ *
+ *    @param  profile   Physical configuration lookup entry.
+ */
+void FrameAdrSelect(unsigned char profile)
+{
+  if (profile != gFrameScheduler.adr.current)
+  {
+    gFrameScheduler.adr.current = profile;
+    PhyConfigure(profile);
+  }
+}
+
+#if defined( PROTOCOL_ENDPOINT )
+/**
+ *  FrameAdrFailure - a frame has been dropped for lack of acknowledgement. If
+ *  the slot is served with a faster profile than the base profile, send the 
+ *  next frames with contention access until the Gateway lowers the profile of
+ *  the slot.
  */
+void FrameAdrFailure()
+{
+  if (!gFrameScheduler.adr.fallback
+      && gFrameScheduler.adr.profile != FRAME_ADR_BASE
+      && gFrameScheduler.tdma.slot != FRAME_TDMA_NO_SLOT)
+  {
+    gFrameScheduler.adr.fallback = true;
+    gFrameScheduler.adr.fallbacks++;
+  }
+}
+#endif
+#endif
 
 // -----------------------------------------------------------------------------
-// Frame configuration
+// Transmit power control
 
+#if defined( PROTOCOL_USE_TPC )
 #if defined( PROTOCOL_ENDPOINT )
-void FrameInit(unsigned char(*FrameComplete)(unsigned char*, unsigned char))
-#elif defined( PROTOCOL_GATEWAY )
-void FrameInit(unsigned char(*FrameComplete)(bool, unsigned char*, unsigned char),
-               bool(*LinkRequest)(unsigned char *payload, unsigned char length))
-#endif
+/**
+ *  FrameTpcSelect - set the output power of the next transmission.
+ *
+ *    @param  power   Output power (dBm).
+ */
+void FrameTpcSelect(tPower power)
 {
-  gFrameScheduler.FrameComplete = FrameComplete;
-  #if defined( PROTOCOL_GATEWAY )
+  if (PhyGetOutputPower() != power)
+  {
+    PhySetOutputPower(power);
+  }
+}
+
+/**
+ *  FrameTpcAcknowledged - a data frame has been acknowledged. The headroom sent
+ *  in the next beacon reflects the output power of the slot if the frame has
+ *  been sent with it.
+ */
+void FrameTpcAcknowledged()
+{
+  gFrameScheduler.tpc.reported = (PhyGetOutputPower() == gFrameScheduler.tpc.power);
+}
+
+/**
+ *  FrameTpcMissed - a data frame has not been acknowledged. The slot goes back
+ *  to the highest output power.
+ */
+void FrameTpcMissed()
+{
+  gFrameScheduler.tpc.reported = false;
+  if (gFrameScheduler.tpc.power != gFrameScheduler.tpc.maximum)
+  {
+    gFrameScheduler.tpc.power = gFrameScheduler.tpc.maximum;
+    gFrameScheduler.tpc.changes++;
+  }
+}
+
+/**
+ *  FrameTpcUpdate - adjust the output power of the slot to the headroom sent in
+ *  the beacon that has been received.
+ *
+ *    @param  beacon  Beacon payload.
+ *    @param  slot    Transmit slot of the End Point.
+ */
+void FrameTpcUpdate(const unsigned char *beacon, unsigned char slot)
+{
+  unsigned char offset = 4 + ((beacon[1] + 7) >> 3) + (slot >> 1);
+  signed int headroom;
+  tPower power;
+  
+  #if defined( PROTOCOL_USE_GROUP_ACK )
+  offset += (beacon[1] + 7) >> 3;
+  #endif
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  offset += FRAME_TDMA_BLOCKED_SIZE;
+  #endif
+  #if defined( PROTOCOL_USE_ADR )
+  offset += (beacon[1] + 1) >> 1;
+  #endif
+  
+  if (!gFrameScheduler.tpc.reported || gFrameScheduler.length <= offset)
+  {
+    return;
+  }
+  
+  // The headroom is a signed nibble.
+  headroom = (beacon[offset] >> ((slot & 1) << 2)) & 0x0F;
+  if (headroom & 0x08)
+  {
+    headroom -= 0x10;
+  }
+  if (headroom == FRAME_TPC_UNKNOWN)
+  {
+    return;
+  }
+  headroom *= FRAME_TPC_STEP;
+  
+  // Lower the output power once the headroom exceeds the hysteresis, raise it
+  // as soon as the margin is missed.
+  if (headroom < 0 || headroom >= PROTOCOL_TPC_HYSTERESIS)
+  {
+    PhySetOutputPower(gFrameScheduler.tpc.power - headroom);
+    power = PhyGetOutputPower();
+    
+    if (power != gFrameScheduler.tpc.power)
+    {
+      gFrameScheduler.tpc.power = power;
+      gFrameScheduler.tpc.reported = false;
+      gFrameScheduler.tpc.changes++;
+    }
+  }
+}
+#elif defined( PROTOCOL_GATEWAY )
+/**
+ *  FrameTpcMeasure - measure the headroom of a frame received in a slot.
+ *
+ *    @param  slot  Transmit slot.
+ *    @param  rssi  RSSI of the frame (dBm).
+ */
+void FrameTpcMeasure(unsigned char slot, signed int rssi)
+{
+  #if defined( PROTOCOL_USE_ADR )
+  rssi -= gFrameAdrSensitivity[gFrameScheduler.adr.profile[slot]];
+  #else
+  rssi -= PROTOCOL_TPC_SENSITIVITY;
+  #endif
+  rssi -= PROTOCOL_TPC_MARGIN;
+  
+  // Round down to a whole step within the range of the headroom map.
+  if (rssi < 0)
+  {
+    rssi -= FRAME_TPC_STEP - 1;
+  }
+  rssi /= FRAME_TPC_STEP;
+  if (rssi <= FRAME_TPC_UNKNOWN)
+  {
+    rssi = FRAME_TPC_UNKNOWN + 1;
+  }
+  else if (rssi > -FRAME_TPC_UNKNOWN - 1)
+  {
+    rssi = -FRAME_TPC_UNKNOWN - 1;
+  }
+  
+  gFrameScheduler.tpc.headroom[slot] = (signed char)rssi;
+}
+#endif
+#endif
+
+// -----------------------------------------------------------------------------
+// Slot schedule
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+/**
+ *  FrameTdmaJoined - determine if the End Point owns a transmit slot.
+ *
+ *    @return True if the End Point is linked and has been assigned a slot.
+ */
+bool FrameTdmaJoined()
+{
+  return (gFrameScheduler.tdma.slot != FRAME_TDMA_NO_SLOT) && PhyAddressLinkExists();
+}
+
+/**
+ *  FrameTdmaWait - keep the frame that has been built into the frame buffer 
+ *  and listen for the beacon that starts the next superframe.
+ */
+void FrameTdmaWait()
+{
+  gFrameScheduler.tdma.length = gFrameScheduler.length;
+  memcpy(&gFrameScheduler.tdma.frame, 
+         &gFrameScheduler.frame, 
+         gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  
+  gFrameScheduler.tdma.waiting = true;
+  #if defined( PROTOCOL_USE_ADR )
+  FrameAdrSelect(FRAME_ADR_BASE);
+  #endif
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  FrameChannelTune(FRAME_CHANNEL_CONTROL);
+  #endif
+  FrameListen();
+  FrameTimerStart(eFrameTimerBeacon, (unsigned int)(2 * FRAME_TDMA_SUPERFRAME));
+}
+
+/**
+ *  FrameTdmaDrop - drop the frame waiting for its slot.
+ */
+void FrameTdmaDrop()
+{
+  gFrameScheduler.tdma.waiting = false;
+  gFrameScheduler.tdma.dropped++;
+  #if defined( PROTOCOL_USE_ACK )
+  gFrameScheduler.ack.waiting = false;
+  #endif
+  gFrameScheduler.length = 0;
+  gFrameScheduler.busy = false;
+  FrameIdle();
+}
+
+/**
+ *  FrameTdmaSlot - the transmit slot has been reached. Send the frame.
+ */
+void FrameTdmaSlot()
+{
+  // Restore the frame (the frame buffer has received the beacon).
+  gFrameScheduler.length = gFrameScheduler.tdma.length;
+  memcpy(&gFrameScheduler.frame, 
+         &gFrameScheduler.tdma.frame, 
+         gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  
+  #if defined( PROTOCOL_USE_ADR )
+  FrameAdrSelect(gFrameScheduler.adr.profile);
+  #endif
+  #if defined( PROTOCOL_USE_TPC )
+  FrameTpcSelect(gFrameScheduler.tpc.power);
+  #endif
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  // The slot is served on the home channel of the End Point.
+  FrameChannelTune(FrameChannelForSlot(gFrameScheduler.tdma.slot, 
+                                       gFrameScheduler.channel.blocked));
+  #endif
+  
+  if (!PhyTransmit((unsigned char*)&gFrameScheduler.frame,
+                   gFrameScheduler.length + FRAME_OVERHEAD_LENGTH))
+  {
+    // Error: physical layer was unable to perform the transmission.
+    FrameTdmaDrop();
+  }
+}
+
+#if defined( PROTOCOL_USE_GROUP_ACK )
+/**
+ *  FrameTdmaAckListen - the frame has been sent in the slot. Sleep until just
+ *  before the next beacon, which carries the group acknowledgement.
+ */
+void FrameTdmaAckListen()
+{
+  unsigned long elapsed;
+  unsigned long superframe;
+  unsigned long delay = 1;
+  
+  // Time since the start of the superframe and superframe length (last beacon).
+  elapsed = (unsigned long)(gFrameScheduler.tdma.slot + 1) * gFrameScheduler.tdma.slotLength;
+  elapsed += PROTOCOL_TDMA_GUARD;
+  elapsed += PhyGetAirtime(gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  superframe = (gFrameScheduler.tdma.slots + 1UL) * gFrameScheduler.tdma.slotLength;
+  
+  if (superframe > elapsed + PROTOCOL_TDMA_GUARD)
+  {
+    delay = superframe - elapsed - PROTOCOL_TDMA_GUARD;
+  }
+  if (delay > 0xFFFFu)
+  {
+    delay = 0xFFFFu;
+  }
+  
+  gFrameScheduler.ack.waiting = true;
+  FrameIdle();
+  FrameTimerStart(eFrameTimerWake, (unsigned int)delay);
+}
+
+/**
+ *  FrameTdmaWake - listen for the beacon carrying the group acknowledgement. 
+ *  The acknowledgement is considered lost if no beacon is received within the
+ *  guard time on both sides and the airtime of the largest beacon.
+ */
+void FrameTdmaWake()
+{
+  #if defined( PROTOCOL_USE_ADR )
+  FrameAdrSelect(FRAME_ADR_BASE);
+  #endif
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  FrameChannelTune(FRAME_CHANNEL_CONTROL);
+  #endif
+  FrameListen();
+  FrameTimerStart(eFrameTimerAck, 
+                  (unsigned int)PhyGetAirtime(FRAME_OVERHEAD_LENGTH + PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH) 
+                  + (2 * PROTOCOL_TDMA_GUARD));
+}
+#endif
+#endif
+
+#if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_TDMA )
+/**
+ *  FrameTdmaFind - find the transmit slot of an End Point.
+ *
+ *    @param  addr  End Point address.
+ *
+ *    @return Slot of the End Point. FRAME_TDMA_NO_SLOT if it has no slot.
+ */
+unsigned char FrameTdmaFind(const unsigned char addr[PHY_ADDRESS_ADDRESS_SIZE])
+{
+  unsigned char slot;
+  
+  for (slot = 0; slot < PROTOCOL_TDMA_SLOTS; slot++)
+  {
+    if ((gFrameScheduler.tdma.map[slot >> 3] & (1u << (slot & 7)))
+        && PhyAddressCompare(gFrameScheduler.tdma.owner[slot], addr, PHY_ADDRESS_ADDRESS_SIZE) == 0)
+    {
+      return slot;
+    }
+  }
+  
+  return FRAME_TDMA_NO_SLOT;
+}
+
+/**
+ *  FrameTdmaAssign - assign a transmit slot to an End Point. An End Point that
+ *  links again keeps its slot.
+ *
+ *    @param  addr  End Point address.
+ *
+ *    @return Assigned slot. FRAME_TDMA_NO_SLOT if every slot is taken.
+ */
+unsigned char FrameTdmaAssign(const unsigned char addr[PHY_ADDRESS_ADDRESS_SIZE])
+{
+  unsigned char slot = FrameTdmaFind(addr);
+  
+  if (slot != FRAME_TDMA_NO_SLOT)
+  {
+    return slot;
+  }
+  
+  for (slot = 0; slot < PROTOCOL_TDMA_SLOTS; slot++)
+  {
+    if (!(gFrameScheduler.tdma.map[slot >> 3] & (1u << (slot & 7))))
+    {
+      gFrameScheduler.tdma.map[slot >> 3] |= (1u << (slot & 7));
+      PhyAddressCopy(gFrameScheduler.tdma.owner[slot], addr, PHY_ADDRESS_ADDRESS_SIZE);
+      #if defined( PROTOCOL_USE_GROUP_ACK )
+      // A new owner starts without a sequence number.
+      gFrameScheduler.tdma.seen[slot >> 3] &= ~(1u << (slot & 7));
+      #endif
+      #if defined( PROTOCOL_USE_ADR )
+      // A new owner starts with the base profile.
+      gFrameScheduler.adr.profile[slot] = FRAME_ADR_BASE;
+      gFrameScheduler.adr.limit[slot] = PROTOCOL_ADR_PROFILES - 1;
+      gFrameScheduler.adr.rssi[slot] = FRAME_ADR_NO_RSSI;
+      #endif
+      #if defined( PROTOCOL_USE_TPC )
+      gFrameScheduler.tpc.headroom[slot] = FRAME_TPC_UNKNOWN;
+      #endif
+      return slot;
+    }
+  }
+  
+  return FRAME_TDMA_NO_SLOT;
+}
+
+#if defined( PROTOCOL_USE_ADR )
+/**
+ *  FrameAdrUpdate - adapt the profile of a slot to a data frame received from
+ *  its owner. A frame received with the profile of its slot updates the 
+ *  averaged RSSI of the slot, from which the fastest profile that keeps 
+ *  PROTOCOL_ADR_MARGIN is selected. A frame received with the base profile
+ *  while the slot is served with a faster one comes from an End Point that has
+ *  fallen back to contention access: the slot goes one profile down and is not
+ *  moved above it again.
+ *
+ *    @param  slot  Transmit slot.
+ *    @param  rssi  RSSI of the frame (dBm).
+ *
+ *    @return True if the frame has been received with the profile of its slot.
+ */
+bool FrameAdrUpdate(unsigned char slot, signed int rssi)
+{
+  unsigned char profile = gFrameScheduler.adr.profile[slot];
+  
+  if (gFrameScheduler.adr.current != profile)
+  {
+    if (gFrameScheduler.adr.current == FRAME_ADR_BASE)
+    {
+      gFrameScheduler.adr.limit[slot] = profile - 1;
+      gFrameScheduler.adr.profile[slot] = profile - 1;
+      gFrameScheduler.adr.changes++;
+    }
+    return false;
+  }
+  
+  // Average over about four frames.
+  if (gFrameScheduler.adr.rssi[slot] != FRAME_ADR_NO_RSSI)
+  {
+    rssi = ((3 * (signed int)gFrameScheduler.adr.rssi[slot]) + rssi) / 4;
+  }
+  gFrameScheduler.adr.rssi[slot] = (signed char)rssi;
+  
+  profile = gFrameScheduler.adr.limit[slot];
+  while (profile > FRAME_ADR_BASE 
+         && rssi < gFrameAdrSensitivity[profile] + PROTOCOL_ADR_MARGIN)
+  {
+    profile--;
+  }
+  
+  if (profile != gFrameScheduler.adr.profile[slot])
+  {
+    gFrameScheduler.adr.profile[slot] = profile;
+    gFrameScheduler.adr.changes++;
+  }
+  
+  return true;
+}
+#endif
+
+#if defined( PROTOCOL_USE_ADR ) || defined( PROTOCOL_USE_TPC )
+/**
+ *  FrameTdmaReport - account for a data frame received from the owner of a 
+ *  slot: adapt the profile of the slot, then measure the headroom of the frame
+ *  against the profile that the slot is served with next.
+ */
+void FrameTdmaReport()
+{
+  unsigned char slot = FrameTdmaFind(gFrameScheduler.frame.header.srcAddr);
+  signed int rssi = PhyGetDataStreamStatus()->rssi;
+  
+  if (slot == FRAME_TDMA_NO_SLOT)
+  {
+    return;
+  }
+  
+  #if defined( PROTOCOL_USE_ADR )
+  if (!FrameAdrUpdate(slot, rssi))
+  {
+    return;
+  }
+  #endif
+  #if defined( PROTOCOL_USE_TPC )
+  FrameTpcMeasure(slot, rssi);
+  #endif
+}
+#endif
+#endif
+
+// -----------------------------------------------------------------------------
+// Frame transmission
+
+/**
+ *  FrameTransmitDirect - transmit the frame that has been built into the frame
+ *  buffer without waiting for a transmit slot. With CSMA/CA (End Point) the 
+ *  frame is deferred by a random backoff and sent from the frame timer once the
+ *  channel is clear.
+ *
+ *    @return Success of the operation. The frame scheduler is busy if the frame
+ *            has been accepted.
+ */
+bool FrameTransmitDirect()
+{
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ADR )
+  // Contention access uses the base profile.
+  FrameAdrSelect(FRAME_ADR_BASE);
+  #endif
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TPC )
+  // Contention access uses the highest output power.
+  FrameTpcSelect(gFrameScheduler.tpc.maximum);
+  #endif
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  // Contention access uses the control channel.
+  FrameChannelTune(FRAME_CHANNEL_CONTROL);
+  #endif
+  
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+  // The frame is sent by the backoff timer once the channel is clear. The
+  // scheduler remains busy until the frame is sent or dropped.
+  gFrameScheduler.busy = true;
+  gFrameScheduler.csma.backoffs = 0;
+  gFrameScheduler.csma.exponent = PROTOCOL_CSMA_MIN_BE;
+  #if defined( PROTOCOL_USE_ACK )
+  // Retransmissions start with a larger contention window.
+  gFrameScheduler.csma.exponent += gFrameScheduler.ack.retries;
+  if (gFrameScheduler.csma.exponent > PROTOCOL_CSMA_MAX_BE)
+  {
+    gFrameScheduler.csma.exponent = PROTOCOL_CSMA_MAX_BE;
+  }
+  #endif
+  FrameCsmaBackoff();
+  return true;
+  #else
+  if (PhyTransmit((unsigned char*)&gFrameScheduler.frame,
+                  gFrameScheduler.length + FRAME_OVERHEAD_LENGTH))
+  {
+    // The frame scheduler is only busy if the physical layer has accepted
+    // to transmit the frame.
+    gFrameScheduler.busy = true;
+    #if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_TDMA )
+    gFrameScheduler.tdma.transmitting = true;
+    #endif
+    return true;
+  }
+  
+  // Error: physical layer was unable to perform the transmission.
+  return false;
+  #endif
+}
+
+/**
+ *  FrameTransmit - transmit the frame that has been built into the frame
+ *  buffer. With TDMA the data frames of a linked End Point wait for its slot;
+ *  other frames are sent directly (see FrameTransmitDirect).
+ *
+ *    @return Success of the operation. The frame scheduler is busy if the frame
+ *            has been accepted.
+ */
+bool FrameTransmit()
+{
+  if ((gFrameScheduler.length + FRAME_OVERHEAD_LENGTH) > PROTOCOL_DATASTREAM_MAX_SIZE)
+  {
+    // Error: Size of the frame is too large. Only End Point data messages are
+    // fragmented (PROTOCOL_USE_FRAGMENTATION).
+    return false;
+  }
+  
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+  // Data frames of a linked End Point are sent in its slot.
+  if (FrameTdmaJoined()
+      && (gFrameScheduler.frame.header.control & FRAME_CONTROL_TYPE) == eFrameTypeData)
+  {
+    FrameTdmaWait();
+    return true;
+  }
+  #endif
+  
+  return FrameTransmitDirect();
+}
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( FRAME_USE_TIMER )
+/**
+ *  FrameTransmitPending - send the frame whose backoff has expired.
+ */
+void FrameTransmitPending()
+{
+  #if defined( PROTOCOL_USE_CSMA )
+  FrameCsmaListen();
+  #else
+  if (!PhyTransmit((unsigned char*)&gFrameScheduler.frame,
+                   gFrameScheduler.length + FRAME_OVERHEAD_LENGTH))
+  {
+    // Error: physical layer was unable to perform the transmission.
+    #if defined( PROTOCOL_USE_ACK )
+    gFrameScheduler.ack.waiting = false;
+    #endif
+    gFrameScheduler.length = 0;
+    gFrameScheduler.busy = false;
+    FrameIdle();
+  }
+  #endif
+}
+#endif
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+/**
+ *  FrameTdmaContend - send the frame waiting for the slot with contention 
+ *  access instead.
+ */
+void FrameTdmaContend()
+{
+  gFrameScheduler.length = gFrameScheduler.tdma.length;
+  memcpy(&gFrameScheduler.frame, 
+         &gFrameScheduler.tdma.frame, 
+         gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  
+  FrameIdle();
+  if (!FrameTransmitDirect())
+  {
+    FrameTdmaDrop();
+  }
+}
+#endif
+
+#if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_TDMA )
+/**
+ *  FrameSendBeacon - start a superframe by broadcasting the slot map (and the
+ *  group acknowledgements). The 
+ *  beacon pre-empts reception as End Points never transmit in the beacon slot.
+ *  It is deferred by one timer tick while a frame is being sent.
+ */
+void FrameSendBeacon()
+{
+  unsigned char beacon[FRAME_TDMA_BEACON_LENGTH];
+  
+  if (gFrameScheduler.tdma.transmitting)
+  {
+    FrameTimerStart(eFrameTimerBeacon, 1);
+    return;
+  }
+  #if defined( FRAME_TDMA_HOPPING )
+  // Hop through the transmit slots of the superframe.
+  gFrameScheduler.tdma.current = 0;
+  FrameTimerStart(eFrameTimerSlot, PROTOCOL_TDMA_SLOT_LENGTH);
+  #else
+  FrameTimerStart(eFrameTimerBeacon, (unsigned int)FRAME_TDMA_SUPERFRAME);
+  #endif
+  
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  #if (PROTOCOL_CHANNEL_SURVEY_PERIOD > 0)
+  // Re-evaluate the energy on the channel list. The beacon runs from the timer
+  // interrupt, so a survey measures a single channel per superframe.
+  if (gFrameScheduler.channel.sweep < PROTOCOL_CHANNEL_LIST_SIZE)
+  {
+    FrameChannelMeasure(gFrameScheduler.channel.sweep++);
+    if (gFrameScheduler.channel.sweep == PROTOCOL_CHANNEL_LIST_SIZE)
+    {
+      FrameChannelBlock();
+    }
+  }
+  else if (++gFrameScheduler.channel.survey >= PROTOCOL_CHANNEL_SURVEY_PERIOD)
+  {
+    gFrameScheduler.channel.survey = 0;
+    gFrameScheduler.channel.sweep = 1;
+    FrameChannelMeasure(0);
+  }
+  #endif
+  
+  // Blocked data channels are used again after PROTOCOL_CHANNEL_BLOCK_PERIOD
+  // superframes.
+  if (gFrameScheduler.channel.pending != 0
+      && ++gFrameScheduler.channel.age >= PROTOCOL_CHANNEL_BLOCK_PERIOD)
+  {
+    gFrameScheduler.channel.pending = 0;
+  }
+  gFrameScheduler.channel.blocked = gFrameScheduler.channel.pending;
+  beacon[FRAME_TDMA_BLOCKED_OFFSET] = gFrameScheduler.channel.blocked;
+  #endif
+  #if defined( PROTOCOL_USE_ADR )
+  // Send the profile of every slot.
+  {
+    unsigned char slot;
+    
+    memset(&beacon[FRAME_TDMA_PROFILE_OFFSET], 0, FRAME_TDMA_PROFILE_MAP_SIZE);
+    for (slot = 0; slot < PROTOCOL_TDMA_SLOTS; slot++)
+    {
+      beacon[FRAME_TDMA_PROFILE_OFFSET + (slot >> 1)] |= 
+        gFrameScheduler.adr.profile[slot] << ((slot & 1) << 2);
+    }
+  }
+  #endif
+  #if defined( PROTOCOL_USE_TPC )
+  // Send the headroom of every slot.
+  {
+    unsigned char slot;
+    
+    memset(&beacon[FRAME_TDMA_HEADROOM_OFFSET], 0, FRAME_TDMA_HEADROOM_MAP_SIZE);
+    for (slot = 0; slot < PROTOCOL_TDMA_SLOTS; slot++)
+    {
+      beacon[FRAME_TDMA_HEADROOM_OFFSET + (slot >> 1)] |= 
+        ((unsigned char)gFrameScheduler.tpc.headroom[slot] & 0x0Fu) << ((slot & 1) << 2);
+    }
+  }
+  #endif
+  
+  beacon[0] = gFrameScheduler.tdma.sequence++;
+  beacon[1] = PROTOCOL_TDMA_SLOTS;
+  beacon[2] = (unsigned char)(PROTOCOL_TDMA_SLOT_LENGTH >> 8);
+  beacon[3] = (unsigned char)PROTOCOL_TDMA_SLOT_LENGTH;
+  memcpy(&beacon[4], gFrameScheduler.tdma.map, FRAME_TDMA_MAP_SIZE);
+  #if defined( PROTOCOL_USE_GROUP_ACK )
+  // Acknowledge the frames received during the superframe that has ended.
+  memcpy(&beacon[4 + FRAME_TDMA_MAP_SIZE], gFrameScheduler.tdma.acked, FRAME_TDMA_MAP_SIZE);
+  memset(gFrameScheduler.tdma.acked, 0, FRAME_TDMA_MAP_SIZE);
+  #endif
+  
+  PhyIdle();
+  gFrameScheduler.busy = false;
+  #if defined( PROTOCOL_USE_ADR )
+  FrameAdrSelect(FRAME_ADR_BASE);
+  #endif
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  FrameChannelTune(FRAME_CHANNEL_CONTROL);
+  #endif
+  FrameBuild(eFrameTypeBeacon, false, beacon, FRAME_TDMA_BEACON_LENGTH);
+  memset(gFrameScheduler.frame.header.destAddr, 
+         PHY_ADDRESS_BROADCAST, 
+         PHY_ADDRESS_ADDRESS_SIZE);
+  
+  PhyEnable();
+  if (!FrameTransmit())
+  {
+    FrameIdle();
+  }
+}
+
+#if defined( FRAME_TDMA_HOPPING )
+/**
+ *  FrameTdmaHop - tune to the channel and profile of the next transmit slot, or
+ *  send the beacon once the last slot has ended. Unassigned slots are served on
+ *  the control channel with the base profile. The hop is deferred by one timer
+ *  tick while a frame is being sent.
+ */
+void FrameTdmaHop()
+{
+  unsigned char slot = gFrameScheduler.tdma.current;
+  bool retune = false;
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  unsigned char index = FRAME_CHANNEL_CONTROL;
+  #endif
+  #if defined( PROTOCOL_USE_ADR )
+  unsigned char profile = FRAME_ADR_BASE;
+  #endif
+  
+  if (gFrameScheduler.tdma.transmitting)
+  {
+    FrameTimerStart(eFrameTimerSlot, 1);
+    return;
+  }
+  
+  if (slot >= PROTOCOL_TDMA_SLOTS)
+  {
+    FrameSendBeacon();
+    return;
+  }
+  gFrameScheduler.tdma.current++;
+  FrameTimerStart(eFrameTimerSlot, PROTOCOL_TDMA_SLOT_LENGTH);
+  
+  if (gFrameScheduler.tdma.map[slot >> 3] & (1u << (slot & 7)))
+  {
+    #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+    index = FrameChannelForSlot(slot, gFrameScheduler.channel.blocked);
+    #endif
+    #if defined( PROTOCOL_USE_ADR )
+    profile = gFrameScheduler.adr.profile[slot];
+    #endif
+  }
+  
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  retune = retune || (index != gFrameScheduler.channel.current);
+  #endif
+  #if defined( PROTOCOL_USE_ADR )
+  retune = retune || (profile != gFrameScheduler.adr.current);
+  #endif
+  
+  if (retune)
+  {
+    PhyIdle();
+    gFrameScheduler.busy = false;
+    #if defined( PROTOCOL_USE_ADR )
+    FrameAdrSelect(profile);
+    #endif
+    #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+    FrameChannelTune(index);
+    #endif
+    FrameIdle();
+  }
+}
+#endif
+#endif
+
+// -----------------------------------------------------------------------------
+// Fragmentation
+
+#if defined( PROTOCOL_USE_FRAGMENTATION )
+#if defined( PROTOCOL_ENDPOINT )
+/**
+ *  FrameFragmentSend - build and send the next fragment of the message. All 
+ *  fragments but the last one fill the frame. Only the last fragment carries
+ *  the data request.
+ *
+ *    @return Success of the operation. The frame scheduler is busy if the 
+ *            fragment has been accepted.
+ */
+bool FrameFragmentSend()
+{
+  unsigned char *payload = gFrameScheduler.fragment.payload;
+  unsigned char length = gFrameScheduler.fragment.remaining;
+  bool dataRequest = gFrameScheduler.fragment.dataRequest;
+  
+  if (length > FRAME_FRAGMENT_PAYLOAD_LENGTH)
+  {
+    length = FRAME_FRAGMENT_PAYLOAD_LENGTH;
+    dataRequest = false;
+  }
+  gFrameScheduler.fragment.payload += length;
+  gFrameScheduler.fragment.remaining -= length;
+  
+  FrameBuild(eFrameTypeData, dataRequest, payload, length);
+  
+  return FrameTransmit();
+}
+
+/**
+ *  FrameFragmentNext - the fragment being sent has completed (sent or 
+ *  acknowledged). Send the next fragment of the message.
+ *
+ *    @return True if the message has not completed, otherwise false.
+ */
+bool FrameFragmentNext()
+{
+  if (gFrameScheduler.fragment.remaining == 0)
+  {
+    return false;
+  }
+  
+  gFrameScheduler.fragment.index++;
+  if (!FrameFragmentSend())
+  {
+    // Error: physical layer was unable to send the fragment. Drop the message.
+    gFrameScheduler.fragment.remaining = 0;
+  }
+  
+  return true;
+}
+
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+/**
+ *  FrameFragmentCost - get the tokens drawn by the fragments of a data message.
+ *
+ *    @param  length  Number of bytes in the message.
+ *
+ *    @return Tokens drawn by sending all fragments once.
+ */
+signed long FrameFragmentCost(unsigned char length)
+{
+  signed long cost = 0;
+  
+  while (length > FRAME_FRAGMENT_PAYLOAD_LENGTH)
+  {
+    cost += FrameDutyCycleCost(PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH + FRAME_OVERHEAD_LENGTH);
+    length -= FRAME_FRAGMENT_PAYLOAD_LENGTH;
+  }
+  
+  return cost + FrameDutyCycleCost(length + FRAME_FRAGMENT_HEADER_LENGTH + FRAME_OVERHEAD_LENGTH);
+}
+#endif
+#elif defined( PROTOCOL_GATEWAY )
+/**
+ *  FrameReassemblyFind - find the reassembly buffer in use by a source.
+ *
+ *    @param  addr  Address of the source.
+ *
+ *    @return Location of the buffer, NULL if the source has none.
+ */
+struct sFrameReassembly* FrameReassemblyFind(const unsigned char addr[PHY_ADDRESS_ADDRESS_SIZE])
+{
+  unsigned char i;
+  
+  for (i = 0; i < PROTOCOL_FRAGMENT_BUFFERS; i++)
+  {
+    if (gFrameScheduler.fragment.buffer[i].timeout != 0
+        && PhyAddressCompare(gFrameScheduler.fragment.buffer[i].srcAddr,
+                             addr,
+                             PROTOCOL_PHYADDRESS_ADDRESS_SIZE) == 0)
+    {
+      return &gFrameScheduler.fragment.buffer[i];
+    }
+  }
+  
+  return NULL;
+}
+
+/**
+ *  FrameReassemblyOpen - take a reassembly buffer for a new message. A free 
+ *  buffer is taken first, otherwise the message closest to its timeout is
+ *  discarded.
+ *
+ *    @param  addr  Address of the source.
+ *
+ *    @return Location of the buffer.
+ */
+struct sFrameReassembly* FrameReassemblyOpen(const unsigned char addr[PHY_ADDRESS_ADDRESS_SIZE])
+{
+  struct sFrameReassembly *buffer = &gFrameScheduler.fragment.buffer[0];
+  unsigned char i;
+  
+  for (i = 1; i < PROTOCOL_FRAGMENT_BUFFERS; i++)
+  {
+    if (gFrameScheduler.fragment.buffer[i].timeout < buffer->timeout)
+    {
+      buffer = &gFrameScheduler.fragment.buffer[i];
+    }
+  }
+  
+  if (buffer->timeout != 0)
+  {
+    // Error: no buffer is free.
+    gFrameScheduler.fragment.discarded++;
+  }
+  
+  PhyAddressCopy(buffer->srcAddr, addr, PROTOCOL_PHYADDRESS_ADDRESS_SIZE);
+  buffer->index = 0;
+  buffer->length = 0;
+  
+  return buffer;
+}
+
+/**
+ *  FrameReassemble - add the received data frame to the message of its source.
+ *  A fragment with index zero starts a message; any other fragment must be the
+ *  next one of the message in the buffer of its source.
+ *
+ *    @param  payload   Set to the location of the message once complete.
+ *    @param  length    Set to the number of bytes in the message once complete.
+ *
+ *    @return True if the message is complete, otherwise false.
+ */
+bool FrameReassemble(unsigned char **payload, unsigned char *length)
+{
+  struct sFrameReassembly *buffer = FrameReassemblyFind(gFrameScheduler.frame.header.srcAddr);
+  bool pending = (gFrameScheduler.frame.header.control & FRAME_CONTROL_PENDING) != 0;
+  unsigned char index;
+  unsigned char size;
+  
+  // Error: the frame carries no fragment header.
+  if (gFrameScheduler.length < FRAME_FRAGMENT_HEADER_LENGTH)
+  {
+    return false;
+  }
+  
+  index = gFrameScheduler.frame.payload[0];
+  size = gFrameScheduler.length - FRAME_FRAGMENT_HEADER_LENGTH;
+  
+  if (buffer != NULL && index != buffer->index)
+  {
+    // Error: the message of the source is incomplete.
+    buffer->timeout = 0;
+    buffer = NULL;
+    gFrameScheduler.fragment.discarded++;
+  }
+  
+  if (buffer == NULL)
+  {
+    // A message of one frame is passed up from the frame buffer.
+    if (index == 0 && !pending)
+    {
+      *payload = &gFrameScheduler.frame.payload[FRAME_FRAGMENT_HEADER_LENGTH];
+      *length = size;
+      return true;
+    }
+    
+    // Error: the start of the message has been missed.
+    if (index != 0)
+    {
+      return false;
+    }
+    
+    buffer = FrameReassemblyOpen(gFrameScheduler.frame.header.srcAddr);
+  }
+  
+  if (buffer->length + size > PROTOCOL_FRAGMENT_MAX_LENGTH)
+  {
+    // Error: the message is too long for the buffer.
+    buffer->timeout = 0;
+    gFrameScheduler.fragment.discarded++;
+    return false;
+  }
+  
+  memcpy(&buffer->data[buffer->length], 
+         &gFrameScheduler.frame.payload[FRAME_FRAGMENT_HEADER_LENGTH], 
+         size);
+  buffer->length += size;
+  buffer->index++;
+  
+  if (pending)
+  {
+    // Wait for the next fragment.
+    buffer->timeout = PROTOCOL_FRAGMENT_TIMEOUT;
+    PhyTimerStart();
+    return false;
+  }
+  
+  // The message is complete. The buffer is released but keeps the message
+  // until the next one is reassembled.
+  buffer->timeout = 0;
+  *payload = buffer->data;
+  *length = buffer->length;
+  
+  return true;
+}
+
+/**
+ *  FrameReassemblyAge - age the reassembly buffers by one timer tick. The 
+ *  physical timer is stopped once no buffer waits for a fragment and no frame
+ *  timer event is pending.
+ */
+void FrameReassemblyAge()
+{
+  bool waiting = false;
+  unsigned char i;
+  
+  for (i = 0; i < PROTOCOL_FRAGMENT_BUFFERS; i++)
+  {
+    struct sFrameReassembly *buffer = &gFrameScheduler.fragment.buffer[i];
+    
+    if (buffer->timeout != 0)
+    {
+      if (--buffer->timeout == 0)
+      {
+        // Error: the next fragment has not been received in time.
+        gFrameScheduler.fragment.discarded++;
+      }
+      else
+      {
+        waiting = true;
+      }
+    }
+  }
+  
+  if (!waiting && gFrameScheduler.timer.delay == 0)
+  {
+    PhyTimerStop();
+  }
+}
+#endif
+#endif
+
+// -----------------------------------------------------------------------------
+// Acknowledgements
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+/**
+ *  FrameAckListen - listen for the acknowledgement of the frame just sent. The
+ *  window covers the airtime of an acknowledgement frame plus the Gateway
+ *  processing time.
+ */
+void FrameAckListen()
+{
+  gFrameScheduler.ack.waiting = true;
+  FrameListen();
+  FrameTimerStart(eFrameTimerAck, 
+                  (unsigned int)PhyGetAirtime(FRAME_OVERHEAD_LENGTH) + PROTOCOL_ACK_TURNAROUND);
+}
+
+/**
+ *  FrameAckTimeout - the acknowledgement window has elapsed. Retransmit the
+ *  frame after a random backoff, or drop it once PROTOCOL_ACK_MAX_RETRIES
+ *  retransmissions have not been acknowledged.
+ */
+void FrameAckTimeout()
+{
+  gFrameScheduler.busy = false;
+  FrameIdle();
+  
+  #if defined( PROTOCOL_USE_TPC )
+  FrameTpcMissed();
+  #endif
+  
+  if (gFrameScheduler.ack.retries >= PROTOCOL_ACK_MAX_RETRIES)
+  {
+    // Error: the frame has not been acknowledged. Drop the frame.
+    gFrameScheduler.ack.failures++;
+    gFrameScheduler.ack.waiting = false;
+    gFrameScheduler.length = 0;
+    #if defined( PROTOCOL_USE_ADR )
+    FrameAdrFailure();
+    #endif
+    return;
+  }
+  
+  // Restore the frame (the frame buffer is shared with reception).
+  gFrameScheduler.ack.retries++;
+  gFrameScheduler.length = gFrameScheduler.ack.length;
+  memcpy(&gFrameScheduler.frame, 
+         &gFrameScheduler.ack.frame, 
+         gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  
+  #if defined( PROTOCOL_USE_TDMA )
+  // The retransmission is sent in the slot of a later superframe.
+  if (FrameTdmaJoined())
+  {
+    FrameTransmit();
+    return;
+  }
+  #endif
+  
+  #if defined( PROTOCOL_USE_CSMA )
+  FrameTransmit();
+  #else
+  gFrameScheduler.busy = true;
+  FrameBackoff(gFrameScheduler.ack.retries, PROTOCOL_ACK_BACKOFF_PERIOD);
+  #endif
+}
+
+/**
+ *  FrameAckReceived - process an incoming acknowledgement. Only the
+ *  acknowledgement of the pending frame (same sequence number) completes the
+ *  transfer.
+ *
+ *    @return Status message from callee (currently not being used for frame 
+ *            use).
+ */
+unsigned char FrameAckReceived()
+{
+  if (gFrameScheduler.ack.waiting
+      && gFrameScheduler.frame.header.seqNumber == gFrameScheduler.ack.frame.header.seqNumber)
+  {
+    FrameTimerStop();
+    gFrameScheduler.ack.waiting = false;
+    #if defined( PROTOCOL_USE_TDMA )
+    // A late acknowledgement also ends the wait for a retransmission slot.
+    gFrameScheduler.tdma.waiting = false;
+    #endif
+    #if defined( PROTOCOL_USE_TPC )
+    FrameTpcAcknowledged();
+    #endif
+    gFrameScheduler.length = 0;
+    
+    #if defined( PROTOCOL_USE_FRAGMENTATION )
+    if (FrameFragmentNext())
+    {
+      return 0;
+    }
+    #endif
+    
+    // The transfer has completed.
+    if (gFrameScheduler.FrameComplete != NULL)
+    {
+      return gFrameScheduler.FrameComplete(NULL, 0);
+    }
+  }
+  
+  return 0;
+}
+#endif
+
+/**
+ *  FrameRelease - leave the receive operation once an incoming frame has been
+ *  processed. An End Point that is waiting for an acknowledgement or a beacon
+ *  keeps listening until the wait elapses.
+ */
+void FrameRelease()
+{
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+  if (gFrameScheduler.ack.waiting)
+  {
+    FrameListen();
+    return;
+  }
+  #endif
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+  if (gFrameScheduler.tdma.waiting)
+  {
+    FrameListen();
+    return;
+  }
+  #endif
+  
+  FrameIdle();
+}
+
+#if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_ACK )
+/**
+ *  FrameAckDuplicate - determine if the received frame is a retransmission of
+ *  the last acknowledged frame and record it as the last acknowledged frame.
+ *
+ *    @return True if the frame has already been acknowledged, otherwise false.
+ */
+bool FrameAckDuplicate()
+{
+  if (gFrameScheduler.ack.valid
+      && gFrameScheduler.ack.seqNumber == gFrameScheduler.frame.header.seqNumber
+      && PhyAddressCompare(gFrameScheduler.ack.srcAddr,
+                           gFrameScheduler.frame.header.srcAddr,
+                           PROTOCOL_PHYADDRESS_ADDRESS_SIZE) == 0)
+  {
+    return true;
+  }
+  
+  gFrameScheduler.ack.valid = true;
+  gFrameScheduler.ack.seqNumber = gFrameScheduler.frame.header.seqNumber;
+  PhyAddressCopy(gFrameScheduler.ack.srcAddr,
+                 gFrameScheduler.frame.header.srcAddr,
+                 PROTOCOL_PHYADDRESS_ADDRESS_SIZE);
+  
+  return false;
+}
+
+/**
+ *  FrameSendAck - acknowledge the received frame. The acknowledgement is a data
+ *  frame without payload that carries the ACK control bit and the sequence
+ *  number of the acknowledged frame.
+ *
+ *    @param  seqNumber   Sequence number of the acknowledged frame.
+ */
+void FrameSendAck(unsigned char seqNumber)
+{
+  FrameBuild(eFrameTypeData, false, NULL, 0);
+  gFrameScheduler.frame.header.control |= FRAME_CONTROL_ACK;
+  gFrameScheduler.frame.header.seqNumber = seqNumber;
+  
+  PhyEnable();
+  FrameTransmit();
+}
+
+#if defined( PROTOCOL_USE_GROUP_ACK )
+/**
+ *  FrameGroupAck - record the received frame in the ack map of the next beacon
+ *  if it has been sent in the slot of its End Point.
+ *
+ *    @param  duplicate   Set if the frame is a retransmission of a frame that
+ *                        has already been received in the slot.
+ *
+ *    @return True if the frame is acknowledged by the next beacon, otherwise
+ *            false (the frame must be acknowledged immediately).
+ */
+bool FrameGroupAck(bool *duplicate)
+{
+  unsigned char slot = FrameTdmaFind(gFrameScheduler.frame.header.srcAddr);
+  unsigned char mask;
+  
+  if (slot == FRAME_TDMA_NO_SLOT)
+  {
+    return false;
+  }
+  
+  #if defined( PROTOCOL_USE_ADR )
+  // A frame received with another profile than the one of the slot has been
+  // sent with contention access.
+  if (gFrameScheduler.adr.current != gFrameScheduler.adr.profile[slot])
+  {
+    return false;
+  }
+  #endif
+  
+  mask = (unsigned char)(1u << (slot & 7));
+  *duplicate = (gFrameScheduler.tdma.seen[slot >> 3] & mask)
+               && gFrameScheduler.tdma.seqNumber[slot] == gFrameScheduler.frame.header.seqNumber;
+  
+  gFrameScheduler.tdma.acked[slot >> 3] |= mask;
+  gFrameScheduler.tdma.seen[slot >> 3] |= mask;
+  gFrameScheduler.tdma.seqNumber[slot] = gFrameScheduler.frame.header.seqNumber;
+  
+  return true;
+}
+#endif
+#endif
+
+// -----------------------------------------------------------------------------
+// Frame scheduler operations
+
+/**
+ *  FrameSchedulerData - scheduler operation to process all incoming data
+ *  frames.
+ *
+ *    @return Status message from callee (currently not being used for frame 
+ *            use).
+ */
+unsigned char FrameSchedulerData(void)
+{ 
+  unsigned char *payload = gFrameScheduler.frame.payload;
+  unsigned char length = gFrameScheduler.length;
+  
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+  // An acknowledgement carries no payload for the next layer.
+  if (gFrameScheduler.frame.header.control & FRAME_CONTROL_ACK)
+  {
+    return FrameAckReceived();
+  }
+  #elif defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_ACK )
+  bool ackRequest = (gFrameScheduler.frame.header.control & FRAME_CONTROL_ACK_REQ) != 0;
+  unsigned char seqNumber = gFrameScheduler.frame.header.seqNumber;
+  
+  #if defined( PROTOCOL_USE_GROUP_ACK )
+  // A frame sent in a slot is acknowledged by the next beacon. The slot keeps
+  // its own duplicate filter as slot frames are not acknowledged in order.
+  if (ackRequest)
+  {
+    bool duplicate = false;
+    
+    if (FrameGroupAck(&duplicate))
+    {
+      if (duplicate)
+      {
+        return 0;
+      }
+      ackRequest = false;
+    }
+  }
+  #endif
+  
+  // A retransmission whose acknowledgement was lost is acknowledged again, but
+  // it is not passed up a second time.
+  if (ackRequest && FrameAckDuplicate())
+  {
+    FrameSendAck(seqNumber);
+    return 0;
+  }
+  
+  #if defined( PROTOCOL_USE_ADR ) || defined( PROTOCOL_USE_TPC )
+  FrameTdmaReport();
+  #endif
+  #endif
+  
+  #if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_FRAGMENTATION )
+  // Only complete messages are passed up. Each fragment is acknowledged.
+  if (!FrameReassemble(&payload, &length))
+  {
+    #if defined( PROTOCOL_USE_ACK )
+    if (ackRequest)
+    {
+      FrameSendAck(seqNumber);
+    }
+    #endif
+    return 0;
+  }
+  #endif
+  
+  // Pass the payload (without frame header and footer) up to the next layer.
+  if (gFrameScheduler.FrameComplete != NULL)
+  {
+    #if defined( PROTOCOL_GATEWAY )
+    bool dataRequest = (gFrameScheduler.frame.header.control & FRAME_CONTROL_DATA_REQ) >> 1;
+    #endif
+    unsigned char statusMessage = 0;
+    
+    gFrameScheduler.frame.header.control &= ~FRAME_CONTROL_DATA_REQ;
+    
+    #if defined( PROTOCOL_ENDPOINT )
+    statusMessage = gFrameScheduler.FrameComplete(payload, length);
+    #elif defined( PROTOCOL_GATEWAY )
+    statusMessage = gFrameScheduler.FrameComplete(dataRequest, payload, length);
+    #endif
+    
+    #if defined( PROTOCOL_GATEWAY )
+    // Send data back to the requesting node, if required.
+    if (dataRequest && (gFrameScheduler.dataResponse.length > 0))
+    {
+      // Send a data response.
+      PhyEnable();
+      FrameSend(eFrameTypeData, 
+                dataRequest, 
+                gFrameScheduler.dataResponse.payload, 
+                gFrameScheduler.dataResponse.length);
+    }
+    #if defined( PROTOCOL_USE_ACK )
+    else if (ackRequest)
+    {
+      // Acknowledge the data frame.
+      FrameSendAck(seqNumber);
+    }
+    #endif
+    #endif
+
+    // Return user callback status message.
+    return statusMessage;
+  }
+  
+  #if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_ACK )
+  if (ackRequest)
+  {
+    FrameSendAck(seqNumber);
+  }
+  #endif
+  
+  return 0;
+}
+
+/**
+ *  FrameSchedulerLinkRequest - scheduler operation to process all incoming link 
+ *  requests.
+ *
+ *    @return Status message from callee (currently not being used for frame 
+ *            use).
+ */
+unsigned char FrameSchedulerLinkRequest(void)
+{
+  #if defined( PROTOCOL_ENDPOINT )
+  // An End Point will receive a link request response if the link request was
+  // approved.
+  PhyAddressLinkEstablish(gFrameScheduler.frame.header.panId,
+                          gFrameScheduler.frame.header.srcAddr);
+  #if defined( PROTOCOL_USE_TDMA )
+  // The response carries the assigned transmit slot.
+  gFrameScheduler.tdma.slot = FRAME_TDMA_NO_SLOT;
+  if (gFrameScheduler.length > 0)
+  {
+    gFrameScheduler.tdma.slot = gFrameScheduler.frame.payload[0];
+  }
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  // The blocked channel mask sets the home channel of the slot.
+  if (gFrameScheduler.length > 1)
+  {
+    gFrameScheduler.channel.blocked = gFrameScheduler.frame.payload[1];
+  }
+  #endif
+  #endif
+  #elif defined( PROTOCOL_GATEWAY )
+  if ((gFrameScheduler.frame.header.control & FRAME_CONTROL_MODE) == FRAME_CONTROL_MODE_ENDPOINT)
+  {
+    bool accept = true;     // Default behavior: accept all incoming requests
+    
+    // A Gateway node will verify the link request and send a link request 
+    // response if the link request has been approved.
+    if (gFrameScheduler.LinkRequest != NULL)
+    {
+      accept = gFrameScheduler.LinkRequest(gFrameScheduler.frame.payload, 
+                                           gFrameScheduler.length);
+    }
+    
+    #if defined( PROTOCOL_USE_TDMA )
+    if (accept)
+    {
+      // The End Point is only admitted if a transmit slot is available. The
+      // response carries the assigned slot.
+      unsigned char slot = FrameTdmaAssign(gFrameScheduler.frame.header.srcAddr);
+      
+      if (slot != FRAME_TDMA_NO_SLOT)
+      {
+        #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+        // The response also carries the blocked channel mask, from which the 
+        // End Point derives its home channel.
+        unsigned char response[2];
+        
+        response[0] = slot;
+        response[1] = gFrameScheduler.channel.blocked;
+        PhyEnable();
+        FrameSend(eFrameTypeLinkRequest, false, response, 2);
+        #else
+        PhyEnable();
+        FrameSend(eFrameTypeLinkRequest, false, &slot, 1);
+        #endif
+      }
+    }
+    #else
+    if (accept)
+    {
+      // The link request has been accepted. Provide a response to the remote
+      // node.
+      PhyEnable();
+      FrameSend(eFrameTypeLinkRequest, false, NULL, 0);
+    }
+    #endif
+  }
+  #endif
+
+  return 0;
+}
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+/**
+ *  FrameSchedulerBeacon - scheduler operation to process all incoming beacons.
+ *  An End Point waiting for a beacon sleeps until its slot starts. An End Point
+ *  waiting for a group acknowledgement completes the transfer if its slot is 
+ *  set in the ack map, otherwise it retransmits in the slot of this superframe.
+ *
+ *    @return Status message from callee (currently not being used for frame 
+ *            use).
+ */
+unsigned char FrameSchedulerBeacon(void)
+{
+  const unsigned char *beacon = gFrameScheduler.frame.payload;
+  unsigned char slot = gFrameScheduler.tdma.slot;
+  unsigned long delay;
+  tTime airtime;
+  
+  if (gFrameScheduler.length < 4)
+  {
+    return 0;
+  }
+  
+  #if defined( PROTOCOL_USE_GROUP_ACK )
+  if (gFrameScheduler.ack.waiting && !gFrameScheduler.tdma.waiting)
+  {
+    FrameTimerStop();
+    
+    if (slot < beacon[1]
+        && gFrameScheduler.length >= 4 + 2 * ((beacon[1] + 7) >> 3)
+        && (beacon[4 + ((beacon[1] + 7) >> 3) + (slot >> 3)] & (1u << (slot & 7))))
+    {
+      // The transfer has completed.
+      gFrameScheduler.ack.waiting = false;
+      #if defined( PROTOCOL_USE_TPC )
+      // The beacon also carries the headroom of the frame.
+      FrameTpcAcknowledged();
+      FrameTpcUpdate(beacon, slot);
+      #endif
+      gFrameScheduler.length = 0;
+      #if defined( PROTOCOL_USE_FRAGMENTATION )
+      // The next fragment waits for the next beacon.
+      if (FrameFragmentNext())
+      {
+        return 0;
+      }
+      #endif
+      if (gFrameScheduler.FrameComplete != NULL)
+      {
+        return gFrameScheduler.FrameComplete(NULL, 0);
+      }
+      return 0;
+    }
+    
+    #if defined( PROTOCOL_USE_TPC )
+    FrameTpcMissed();
+    #endif
+    
+    if (gFrameScheduler.ack.retries >= PROTOCOL_ACK_MAX_RETRIES)
+    {
+      // Error: the frame has not been acknowledged. Drop the frame.
+      gFrameScheduler.ack.failures++;
+      gFrameScheduler.ack.waiting = false;
+      gFrameScheduler.length = 0;
+      #if defined( PROTOCOL_USE_ADR )
+      FrameAdrFailure();
+      #endif
+      return 0;
+    }
+    
+    // Retransmit in the slot of this superframe.
+    gFrameScheduler.ack.retries++;
+    gFrameScheduler.tdma.length = gFrameScheduler.ack.length;
+    memcpy(&gFrameScheduler.tdma.frame, 
+           &gFrameScheduler.ack.frame, 
+           gFrameScheduler.ack.length + FRAME_OVERHEAD_LENGTH);
+    gFrameScheduler.tdma.waiting = true;
+  }
+  #endif
+  
+  if (!gFrameScheduler.tdma.waiting)
+  {
+    return 0;
+  }
+  
+  FrameTimerStop();
+  gFrameScheduler.tdma.waiting = false;
+  gFrameScheduler.tdma.sequence = beacon[0];
+  gFrameScheduler.tdma.slots = beacon[1];
+  gFrameScheduler.tdma.slotLength = ((unsigned int)beacon[2] << 8) | beacon[3];
+  
+  // Verify that the Gateway still holds the slot of the End Point.
+  if (slot >= beacon[1]
+      || gFrameScheduler.length < 4 + ((beacon[1] + 7) >> 3)
+      || !(beacon[4 + (slot >> 3)] & (1u << (slot & 7))))
+  {
+    // The Gateway has released the slot (e.g. it has restarted). Send the 
+    // frame with contention access until the End Point connects again.
+    gFrameScheduler.tdma.slot = FRAME_TDMA_NO_SLOT;
+    #if defined( PROTOCOL_USE_ADR )
+    gFrameScheduler.adr.profile = FRAME_ADR_BASE;
+    gFrameScheduler.adr.fallback = false;
+    #endif
+    FrameTdmaContend();
+    return 0;
+  }
+  
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  // Follow the blocked channel mask of the superframe.
+  {
+    unsigned char offset = 4 + ((beacon[1] + 7) >> 3);
+    
+    #if defined( PROTOCOL_USE_GROUP_ACK )
+    offset += (beacon[1] + 7) >> 3;
+    #endif
+    if (gFrameScheduler.length > offset)
+    {
+      if (FrameChannelForSlot(slot, beacon[offset]) 
+          != FrameChannelForSlot(slot, gFrameScheduler.channel.blocked))
+      {
+        gFrameScheduler.channel.migrations++;
+      }
+      gFrameScheduler.channel.blocked = beacon[offset];
+    }
+  }
+  #endif
+  
+  #if defined( PROTOCOL_USE_ADR )
+  // Serve the slot with the profile selected by the Gateway.
+  {
+    unsigned char offset = 4 + ((beacon[1] + 7) >> 3) + (slot >> 1);
+    
+    #if defined( PROTOCOL_USE_GROUP_ACK )
+    offset += (beacon[1] + 7) >> 3;
+    #endif
+    #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+    offset += FRAME_TDMA_BLOCKED_SIZE;
+    #endif
+    if (gFrameScheduler.length > offset)
+    {
+      unsigned char profile = (beacon[offset] >> ((slot & 1) << 2)) & 0x0Fu;
+      
+      if (profile >= PROTOCOL_ADR_PROFILES)
+      {
+        profile = FRAME_ADR_BASE;
+      }
+      
+      // The fallback ends once the Gateway has lowered the profile.
+      if (profile < gFrameScheduler.adr.profile)
+      {
+        gFrameScheduler.adr.fallback = false;
+      }
+      gFrameScheduler.adr.profile = profile;
+    }
+  }
+  
+  if (gFrameScheduler.adr.fallback)
+  {
+    FrameTdmaContend();
+    return 0;
+  }
+  #endif
+  
+  #if defined( PROTOCOL_USE_TPC )
+  FrameTpcUpdate(beacon, slot);
+  #endif
+  
+  // The superframe started one beacon airtime before the end of the beacon.
+  delay = (unsigned long)(slot + 1) * gFrameScheduler.tdma.slotLength;
+  delay += PROTOCOL_TDMA_GUARD;
+  airtime = PhyGetAirtime(gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  delay = (delay > airtime) ? (delay - airtime) : 1;
+  if (delay > 0xFFFFu)
+  {
+    delay = 0xFFFFu;
+  }
+  
+  // Sleep until the slot starts.
+  FrameIdle();
+  gFrameScheduler.busy = true;
+  FrameTimerStart(eFrameTimerSlot, (unsigned int)delay);
+  
+  return 0;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+/**
+ *  Public interface
+ */
+
+// -----------------------------------------------------------------------------
+// Frame configuration
+
+#if defined( PROTOCOL_ENDPOINT )
+void FrameInit(unsigned char(*FrameComplete)(unsigned char*, unsigned char))
+#elif defined( PROTOCOL_GATEWAY )
+void FrameInit(unsigned char(*FrameComplete)(bool, unsigned char*, unsigned char),
+               bool(*LinkRequest)(unsigned char *payload, unsigned char length))
+#endif
+{
+  gFrameScheduler.FrameComplete = FrameComplete;
+  #if defined( PROTOCOL_GATEWAY )
   gFrameScheduler.LinkRequest = LinkRequest;
   #endif
+  #if defined( FRAME_USE_TIMER )
+  // Seed the backoff sequence with the local address so that End Points
+  // reporting at the same time choose different backoffs. The LFSR state must
+  // never be zero.
+  gFrameScheduler.timer.random = 0xACE1u ^ PhyAddressGetLocalInfo()->address[0];
+  gFrameScheduler.timer.delay = 0;
+  gFrameScheduler.timer.event = eFrameTimerIdle;
+  #endif
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+  gFrameScheduler.csma.busyCount = 0;
+  gFrameScheduler.csma.failures = 0;
+  #endif
+  #if defined( PROTOCOL_USE_ACK )
+  #if defined( PROTOCOL_ENDPOINT )
+  gFrameScheduler.ack.waiting = false;
+  gFrameScheduler.ack.retries = 0;
+  gFrameScheduler.ack.failures = 0;
+  #elif defined( PROTOCOL_GATEWAY )
+  gFrameScheduler.ack.valid = false;
+  #endif
+  #endif
+  #if defined( PROTOCOL_USE_TDMA )
+  gFrameScheduler.tdma.sequence = 0;
+  #if defined( PROTOCOL_ENDPOINT )
+  gFrameScheduler.tdma.waiting = false;
+  gFrameScheduler.tdma.slot = FRAME_TDMA_NO_SLOT;
+  gFrameScheduler.tdma.dropped = 0;
+  gFrameScheduler.tdma.slots = PROTOCOL_TDMA_SLOTS;
+  gFrameScheduler.tdma.slotLength = PROTOCOL_TDMA_SLOT_LENGTH;
+  #elif defined( PROTOCOL_GATEWAY )
+  gFrameScheduler.tdma.transmitting = false;
+  memset(gFrameScheduler.tdma.map, 0, FRAME_TDMA_MAP_SIZE);
+  #if defined( PROTOCOL_USE_GROUP_ACK )
+  memset(gFrameScheduler.tdma.acked, 0, FRAME_TDMA_MAP_SIZE);
+  memset(gFrameScheduler.tdma.seen, 0, FRAME_TDMA_MAP_SIZE);
+  #endif
+  #if defined( FRAME_TDMA_HOPPING )
+  gFrameScheduler.tdma.current = PROTOCOL_TDMA_SLOTS;
+  #endif
+  
+  // Start the first superframe.
+  FrameTimerStart(eFrameTimerBeacon, 1);
+  #endif
+  #endif
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  gFrameScheduler.channel.blocked = 0;
+  gFrameScheduler.channel.migrations = 0;
+  #if defined( PROTOCOL_GATEWAY )
+  gFrameScheduler.channel.pending = 0;
+  gFrameScheduler.channel.age = 0;
+  gFrameScheduler.channel.survey = 0;
+  gFrameScheduler.channel.sweep = PROTOCOL_CHANNEL_LIST_SIZE;
+  memset(gFrameScheduler.channel.errors, 0, FRAME_CHANNEL_DATA_COUNT);
+  
+  // Keep the data channels with high energy out of the first superframes.
+  FrameChannelAssess();
+  #endif
+  #endif
+  #if defined( PROTOCOL_USE_ADR )
+  // The physical layer starts with the first configuration (base profile).
+  gFrameScheduler.adr.current = FRAME_ADR_BASE;
+  #if defined( PROTOCOL_ENDPOINT )
+  gFrameScheduler.adr.profile = FRAME_ADR_BASE;
+  gFrameScheduler.adr.fallback = false;
+  gFrameScheduler.adr.fallbacks = 0;
+  #elif defined( PROTOCOL_GATEWAY )
+  memset(gFrameScheduler.adr.profile, FRAME_ADR_BASE, PROTOCOL_TDMA_SLOTS);
+  memset(gFrameScheduler.adr.limit, PROTOCOL_ADR_PROFILES - 1, PROTOCOL_TDMA_SLOTS);
+  memset(gFrameScheduler.adr.rssi, FRAME_ADR_NO_RSSI, PROTOCOL_TDMA_SLOTS);
+  gFrameScheduler.adr.changes = 0;
+  #endif
+  #endif
+  #if defined( PROTOCOL_USE_DUTY_CYCLE )
+  // Start with a full bucket.
+  gFrameScheduler.duty.tokens = FrameDutyCycleCapacity();
+  gFrameScheduler.duty.denied = 0;
+  #endif
+  #if defined( PROTOCOL_USE_TPC )
+  #if defined( PROTOCOL_ENDPOINT )
+  // Start with the highest output power.
+  PhySetOutputPower(FRAME_TPC_HIGHEST);
+  gFrameScheduler.tpc.maximum = PhyGetOutputPower();
+  gFrameScheduler.tpc.power = gFrameScheduler.tpc.maximum;
+  gFrameScheduler.tpc.reported = false;
+  gFrameScheduler.tpc.changes = 0;
+  #elif defined( PROTOCOL_GATEWAY )
+  memset(gFrameScheduler.tpc.headroom, FRAME_TPC_UNKNOWN, PROTOCOL_TDMA_SLOTS);
+  #endif
+  #endif
+  #if defined( PROTOCOL_USE_FRAGMENTATION )
+  #if defined( PROTOCOL_ENDPOINT )
+  gFrameScheduler.fragment.remaining = 0;
+  gFrameScheduler.fragment.index = 0;
+  #elif defined( PROTOCOL_GATEWAY )
+  // All reassembly buffers are free.
+  memset(gFrameScheduler.fragment.buffer, 0, sizeof(gFrameScheduler.fragment.buffer));
+  gFrameScheduler.fragment.discarded = 0;
+  #endif
+  #endif
   // By default, an End Point will be in low power mode and a Gateway will be
   // in listen mode.
   FrameIdle();
@@ -374,34 +2464,52 @@ bool FrameSend(enum eFrameType type,
                unsigned char *payload, 
                unsigned char length)
 {
-  if (!gFrameScheduler.busy)
+  if (!FrameBusy())
   {
-    // Build the frame.
-    FrameBuild(type, dataRequest, payload, length);
-
-    // Transmit the frame.
-    if ((length + FRAME_OVERHEAD_LENGTH) <= PROTOCOL_DATASTREAM_MAX_SIZE)
+    #if defined( PROTOCOL_USE_DUTY_CYCLE )
+    signed long cost = FrameDutyCycleCost(length + FRAME_OVERHEAD_LENGTH);
+    
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_FRAGMENTATION )
+    if (type == eFrameTypeData)
     {
-      if (PhyTransmit((unsigned char*)&gFrameScheduler.frame,
-                      length + FRAME_OVERHEAD_LENGTH))
-      {
-        // The frame scheduler is only busy if the physical layer has accepted
-        // to transmit the frame.
-        gFrameScheduler.busy = true;
-        return true;
-      }
-      else
-      {
-        // Error: physical layer was unable to perform the transmission.
-        return false;
-      }
+      cost = FrameFragmentCost(length);
     }
-    else
+    #endif
+    
+    // Error: the duty cycle does not allow the airtime of the frame yet.
+    if (gFrameScheduler.duty.tokens < cost)
+    {
+      gFrameScheduler.duty.denied++;
+      return false;
+    }
+    #endif
+    
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_FRAGMENTATION )
+    // A data message is sent as a sequence of fragments. The first fragment is
+    // sent now, the others once the previous one has completed.
+    gFrameScheduler.fragment.remaining = 0;
+    if (type == eFrameTypeData)
+    {
+      gFrameScheduler.fragment.payload = payload;
+      gFrameScheduler.fragment.remaining = length;
+      gFrameScheduler.fragment.index = 0;
+      gFrameScheduler.fragment.dataRequest = dataRequest;
+      
+      return FrameFragmentSend();
+    }
+    #endif
+    
+    // Error: the payload does not fit into the frame buffer.
+    if (length > PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH)
     {
-      // Error: Segmentation is not currently supported. Size of the frame is
-      // too large.
       return false;
     }
+    
+    // Build the frame.
+    FrameBuild(type, dataRequest, payload, length);
+
+    // Transmit the frame.
+    return FrameTransmit();
   }
   
   // Error: the frame scheduler is currently busy.
@@ -413,12 +2521,46 @@ bool FrameSend(enum eFrameType type,
 
 bool FrameBusy()
 {
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+  // The transfer is pending until it is acknowledged or dropped.
+  if (gFrameScheduler.ack.waiting)
+  {
+    return true;
+  }
+  #endif
+  
   return gFrameScheduler.busy;
 }
 
+bool FrameFilter(unsigned char *dataField, unsigned char length)
+{
+  // The frame header is received in place (gFrameScheduler.frame). The rest of
+  // the frame must fit into the frame buffer.
+  if (length < FRAME_OVERHEAD_LENGTH 
+      || length > (FRAME_OVERHEAD_LENGTH + PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH))
+  {
+    return false;
+  }
+  
+  #if defined( PROTOCOL_ENDPOINT )
+  return FrameEndPointValidate(gFrameScheduler.frame.header.panId,
+                               gFrameScheduler.frame.header.destAddr);
+  #elif defined( PROTOCOL_GATEWAY )
+  return FrameGatewayValidate(gFrameScheduler.frame.header.panId,
+                              gFrameScheduler.frame.header.destAddr);
+  #endif
+}
+
 unsigned char FrameAssemble(unsigned char *payload, unsigned char length)
 {            
   gFrameScheduler.busy = false;
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+  // Any reception ends a response window.
+  if (gFrameScheduler.timer.event == eFrameTimerResponse)
+  {
+    FrameTimerStop();
+  }
+  #endif
 
   // Clear the size of the buffer for the next RX or TX payload.
   gFrameScheduler.length = 0;
@@ -443,6 +2585,10 @@ unsigned char FrameAssemble(unsigned char *payload, unsigned char length)
     #endif
     {
       unsigned char statusMessage = 0;
+      
+      #if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_CHANNEL_AGILITY )
+      FrameChannelReport(false);
+      #endif
 
       switch (gFrameScheduler.frame.header.control & FRAME_CONTROL_TYPE)
       {
@@ -452,6 +2598,11 @@ unsigned char FrameAssemble(unsigned char *payload, unsigned char length)
       case eFrameTypeLinkRequest:
         statusMessage = FrameSchedulerLinkRequest();
         break;
+      #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+      case eFrameTypeBeacon:
+        statusMessage = FrameSchedulerBeacon();
+        break;
+      #endif
       default:
         break;
       }
@@ -460,7 +2611,7 @@ unsigned char FrameAssemble(unsigned char *payload, unsigned char length)
       // incoming message before going into an IDLE state.
       if (!gFrameScheduler.busy)
       {
-        FrameIdle();
+        FrameRelease();
       }
       
       return statusMessage;
@@ -473,7 +2624,10 @@ unsigned char FrameAssemble(unsigned char *payload, unsigned char length)
    *  of invalid length was received or a frame with an invalid CRC was 
    *  received.
    */
-  FrameIdle();
+  #if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  FrameChannelReport(true);
+  #endif
+  FrameRelease();
   
   return 0;
 }
@@ -481,6 +2635,53 @@ unsigned char FrameAssemble(unsigned char *payload, unsigned char length)
 unsigned char FrameDisassemble()
 {
   gFrameScheduler.busy = false;
+  
+  #if defined( PROTOCOL_USE_DUTY_CYCLE )
+  // Draw the airtime of the frame sent from the bucket.
+  gFrameScheduler.duty.tokens -= FrameDutyCycleCost(gFrameScheduler.length + FRAME_OVERHEAD_LENGTH);
+  #endif
+
+  #if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_TDMA )
+  gFrameScheduler.tdma.transmitting = false;
+  
+  // Sending a beacon does not complete a transfer.
+  if ((gFrameScheduler.frame.header.control & FRAME_CONTROL_TYPE) == eFrameTypeBeacon)
+  {
+    gFrameScheduler.length = 0;
+    FrameIdle();
+    return 0;
+  }
+  #endif
+
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+  // Check if the data transfer must be acknowledged. The transfer completes
+  // when the acknowledgement is received.
+  if (gFrameScheduler.frame.header.control & FRAME_CONTROL_ACK_REQ)
+  {
+    #if defined( PROTOCOL_USE_GROUP_ACK )
+    // A frame sent in the slot is acknowledged by the next beacon.
+    #if defined( PROTOCOL_USE_ADR )
+    if (FrameTdmaJoined() && !gFrameScheduler.adr.fallback)
+    #else
+    if (FrameTdmaJoined())
+    #endif
+    {
+      FrameTdmaAckListen();
+      return 0;
+    }
+    #endif
+    FrameAckListen();
+    return 0;
+  }
+  #elif defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_ACK )
+  // Sending an acknowledgement does not complete a transfer.
+  if (gFrameScheduler.frame.header.control & FRAME_CONTROL_ACK)
+  {
+    gFrameScheduler.length = 0;
+    FrameIdle();
+    return 0;
+  }
+  #endif
 
   // Check if the data transfer requires a response.
   if (gFrameScheduler.frame.header.control & FRAME_CONTROL_DATA_REQ)
@@ -488,6 +2689,10 @@ unsigned char FrameDisassemble()
     // Begin listening for a response (data or data + ACK). Filter on the 
     // destination address of the frame just sent.
     FrameListen();
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+    // The Gateway responds immediately; stop listening after one slot.
+    FrameTimerStart(eFrameTimerResponse, PROTOCOL_TDMA_SLOT_LENGTH);
+    #endif
     return 0;
   }
   else
@@ -499,6 +2704,18 @@ unsigned char FrameDisassemble()
       
       // Clear the size of the buffer for the next RX or TX payload.
       gFrameScheduler.length = 0;
+      
+      #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_FRAGMENTATION )
+      // The message completes with its last fragment.
+      if (FrameFragmentNext())
+      {
+        if (!gFrameScheduler.busy)
+        {
+          FrameIdle();
+        }
+        return 0;
+      }
+      #endif
     
       // Invoke the data complete callback.
       if (gFrameScheduler.FrameComplete != NULL)
@@ -523,11 +2740,196 @@ unsigned char FrameDisassemble()
 
 unsigned char FrameTimeout()
 {
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+  // The acknowledgement has not been received.
+  if (gFrameScheduler.ack.waiting)
+  {
+    FrameTimerStop();
+    FrameAckTimeout();
+    return 0;
+  }
+  #endif
+  
   gFrameScheduler.busy = false;
   FrameIdle();
   return 0;
 }
 
+#if defined( FRAME_USE_TIMER )
+unsigned char FrameTimer()
+{
+  #if defined( PROTOCOL_USE_DUTY_CYCLE )
+  FrameDutyCycleCredit(1);
+  #endif
+  #if defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_FRAGMENTATION )
+  // The buffers are shared with reception.
+  PROTOCOL_CRITICAL_SECTION(FrameReassemblyAge());
+  #endif
+  
+  if (gFrameScheduler.timer.delay != 0 && --gFrameScheduler.timer.delay == 0)
+  {
+    enum eFrameTimerEvent event = gFrameScheduler.timer.event;
+    
+    FrameTimerStop();
+    switch (event)
+    {
+    #if defined( PROTOCOL_ENDPOINT )
+    case eFrameTimerBackoff:
+      FrameTransmitPending();
+      break;
+    #endif
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+    case eFrameTimerCca:
+      FrameCsmaAttempt();
+      break;
+    #endif
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_ACK )
+    case eFrameTimerAck:
+      FrameAckTimeout();
+      break;
+    #endif
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_TDMA )
+    case eFrameTimerBeacon:
+      // Error: no beacon has been received.
+      FrameTdmaDrop();
+      break;
+    case eFrameTimerSlot:
+      FrameTdmaSlot();
+      break;
+    case eFrameTimerResponse:
+      FrameTimeout();
+      break;
+    #if defined( PROTOCOL_USE_GROUP_ACK )
+    case eFrameTimerWake:
+      FrameTdmaWake();
+      break;
+    #endif
+    #elif defined( PROTOCOL_GATEWAY ) && defined( PROTOCOL_USE_TDMA )
+    case eFrameTimerBeacon:
+      // The frame buffer is shared with reception.
+      PROTOCOL_CRITICAL_SECTION(FrameSendBeacon());
+      break;
+    #if defined( FRAME_TDMA_HOPPING )
+    case eFrameTimerSlot:
+      PROTOCOL_CRITICAL_SECTION(FrameTdmaHop());
+      break;
+    #endif
+    #endif
+    default:
+      break;
+    }
+  }
+  
+  return 0;
+}
+#endif
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+const struct sFrameCsma* FrameGetCsmaInfo()
+{
+  return &gFrameScheduler.csma;
+}
+#endif
+
+#if defined( PROTOCOL_USE_ACK )
+const struct sFrameAck* FrameGetAckInfo()
+{
+  return &gFrameScheduler.ack;
+}
+#endif
+
+unsigned char FrameChannelSurvey(unsigned char *channel, 
+                                 tPower *power, 
+                                 unsigned char count)
+{
+  unsigned char ranked;
+  
+  #if defined( PROTOCOL_ENDPOINT )
+  if (FrameBusy())
+  {
+    return 0;
+  }
+  #elif defined( PROTOCOL_USE_TDMA )
+  if (gFrameScheduler.tdma.transmitting)
+  {
+    return 0;
+  }
+  #endif
+  
+  #if defined( FRAME_USE_TIMER )
+  // Hold the frame timer so that no frame is sent or received during the sweep.
+  PhyTimerStop();
+  #endif
+  
+  PhyIdle();
+  gFrameScheduler.busy = false;
+  ranked = PhyScanChannels(channel, power, count);
+  FrameIdle();
+  
+  #if defined( FRAME_USE_TIMER )
+  if (gFrameScheduler.timer.delay != 0)
+  {
+    PhyTimerStart();
+  }
+  #endif
+  
+  return ranked;
+}
+
+#if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+void FrameSetChannelList(const unsigned char *channel)
+{
+  memcpy(gFrameScheduler.channel.list, channel, PROTOCOL_CHANNEL_LIST_SIZE);
+  gFrameScheduler.channel.current = FRAME_CHANNEL_CONTROL;
+  PhySetChannel(gFrameScheduler.channel.list[FRAME_CHANNEL_CONTROL]);
+}
+
+const struct sFrameChannel* FrameGetChannelInfo()
+{
+  return &gFrameScheduler.channel;
+}
+#endif
+
+#if defined( PROTOCOL_USE_ADR )
+const struct sFrameAdr* FrameGetAdrInfo()
+{
+  return &gFrameScheduler.adr;
+}
+#endif
+
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+void FrameDutyCycleElapsed(unsigned int elapsed)
+{
+  PROTOCOL_CRITICAL_SECTION(FrameDutyCycleCredit(elapsed));
+}
+
+const struct sFrameDutyCycle* FrameGetDutyCycleInfo()
+{
+  return &gFrameScheduler.duty;
+}
+#endif
+
+#if defined( PROTOCOL_USE_TPC )
+const struct sFrameTpc* FrameGetTpcInfo()
+{
+  return &gFrameScheduler.tpc;
+}
+#endif
+
+#if defined( PROTOCOL_USE_FRAGMENTATION )
+const struct sFrameFragment* FrameGetFragmentInfo()
+{
+  return &gFrameScheduler.fragment;
+}
+#endif
+
+#if defined( PROTOCOL_USE_TDMA )
+const struct sFrameTdma* FrameGetTdmaInfo()
+{
+  return &gFrameScheduler.tdma;
+}
+#endif
+
 // -----------------------------------------------------------------------------
 /**
  *  Test stub - test functionality of frame module.
@@ -587,3 +2989,264 @@ int main(void)
 }
 
 #endif  /* TEST_FRAME */
+
+/**
+ *  To measure the collision rate of the CSMA/CA channel access, define the
+ *  following in your compiler preprocessor definitions: "TEST_FRAME_CSMA". The
+ *  stub runs on the host; build this file alone with the End Point
+ *  configuration, and remove the unused sections so that the Physical layer is
+ *  not needed, e.g.
+ *
+ *    gcc -DTEST_FRAME_CSMA -include SimplexTransferLR09Config.h <includes>
+ *        -ffunction-sections -Wl,--gc-sections Frame.c
+ */
+#ifdef TEST_FRAME_CSMA
+
+/**
+ *  Test Example - compare the collision rate of End Points sending at once
+ *  (ALOHA) with End Points using the CSMA/CA backoff of this module.
+ *
+ *  @version    1.0.00
+ *  @date       19 Oct 2026
+ *  @platform   Host PC
+ *  @compiler   Any ANSI C compiler
+ *
+ *  assumptions
+ *  ===========
+ *  - one channel shared by all End Points, simulated in 1ms timer ticks
+ *  - a frame collides if it overlaps any other frame; a capture effect is not
+ *  modelled
+ *  - the clear channel assessment is sampled at the end of the listen delay
+ *  and sees frames started in earlier ticks only; End Points assessing in the
+ *  same tick both transmit (the vulnerable window of the real radio)
+ *  - each End Point runs its own FrameRandom sequence, seeded as FrameInit
+ *  does from its address
+ *
+ *  file dependency
+ *  ===============
+ *  stdio.h : used to report the results
+ *  stdlib.h : traffic generation (rand)
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#if !defined( PROTOCOL_ENDPOINT ) || !defined( PROTOCOL_USE_CSMA )
+#error "Frame Test Error: TEST_FRAME_CSMA requires an End Point with PROTOCOL_USE_CSMA."
+#endif
+
+// -----------------------------------------------------------------------------
+
+#define TEST_CSMA_AIRTIME     7     // Frame airtime (ticks; ~32 bytes at 38.4 kBaud)
+#define TEST_CSMA_INTERVAL    250   // Mean time between the frames of a node (ticks)
+#define TEST_CSMA_FRAMES      500   // Frames generated by each node
+#define TEST_CSMA_MAX_NODES   20
+
+enum eTestNodeState
+{
+  eTestNodeIdle,      // Waiting for the next frame
+  eTestNodeBackoff,   // Random backoff
+  eTestNodeListen,    // Receiver settling before the assessment
+  eTestNodeSending    // Frame on the air
+};
+
+struct sTestNode
+{
+  enum eTestNodeState state;
+  unsigned int wait;            // Ticks until the next event
+  unsigned int random;          // FrameRandom state of the node
+  unsigned char exponent;       // Backoff exponent
+  unsigned char backoffs;       // Busy assessments of the current frame
+  unsigned int generated;       // Frames generated
+  bool collided;                // Frame on the air overlapped another one
+};
+
+struct sTestResult
+{
+  unsigned long sent;           // Frames put on the air
+  unsigned long collided;       // Frames lost to a collision
+  unsigned long dropped;        // Frames dropped after PROTOCOL_CSMA_MAX_BACKOFFS
+};
+
+static struct sTestNode gNodes[TEST_CSMA_MAX_NODES];
+
+// The frame timer is advanced by the simulation.
+void PhyTimerStart()
+{
+}
+
+static unsigned int TestInterval(void)
+{
+  return (unsigned int)(rand() % (2 * TEST_CSMA_INTERVAL)) + 1;
+}
+
+static void TestBackoff(struct sTestNode *node)
+{
+  // Run FrameBackoff on the sequence of the node.
+  gFrameScheduler.timer.random = node->random;
+  FrameBackoff(node->exponent, PROTOCOL_CSMA_BACKOFF_PERIOD);
+  node->random = gFrameScheduler.timer.random;
+  node->wait = gFrameScheduler.timer.delay;
+  node->state = eTestNodeBackoff;
+}
+
+static void TestSend(struct sTestNode *node, struct sTestResult *result)
+{
+  node->state = eTestNodeSending;
+  node->wait = TEST_CSMA_AIRTIME;
+  node->collided = false;
+  result->sent++;
+}
+
+static void TestRun(unsigned char nodes, bool csma, struct sTestResult *result)
+{
+  unsigned char i;
+  unsigned char busy;
+  unsigned char pending;
+  
+  srand(1);
+  memset(result, 0, sizeof(struct sTestResult));
+  for (i = 0; i < nodes; i++)
+  {
+    gNodes[i].state = eTestNodeIdle;
+    gNodes[i].wait = TestInterval();
+    gNodes[i].random = 0xACE1u ^ (i + 1);
+    gNodes[i].generated = 0;
+  }
+  
+  do
+  {
+    // Frames ending in this tick.
+    busy = 0;
+    for (i = 0; i < nodes; i++)
+    {
+      if (gNodes[i].wait != 0)
+      {
+        gNodes[i].wait--;
+      }
+      if (gNodes[i].state == eTestNodeSending)
+      {
+        if (gNodes[i].wait == 0)
+        {
+          result->collided += gNodes[i].collided;
+          gNodes[i].state = eTestNodeIdle;
+          gNodes[i].wait = TestInterval();
+        }
+        else
+        {
+          busy++;
+        }
+      }
+    }
+    
+    // Frames generated, backoffs expiring and channel assessments.
+    for (i = 0; i < nodes; i++)
+    {
+      struct sTestNode *node = &gNodes[i];
+      
+      if (node->wait != 0)
+      {
+        continue;
+      }
+      
+      switch (node->state)
+      {
+      case eTestNodeIdle:
+        if (node->generated < TEST_CSMA_FRAMES)
+        {
+          node->generated++;
+          if (csma)
+          {
+            node->exponent = PROTOCOL_CSMA_MIN_BE;
+            node->backoffs = 0;
+            TestBackoff(node);
+          }
+          else
+          {
+            TestSend(node, result);
+          }
+        }
+        break;
+      case eTestNodeBackoff:
+        node->state = eTestNodeListen;
+        node->wait = PROTOCOL_CSMA_LISTEN_DELAY;
+        break;
+      case eTestNodeListen:
+        if (busy == 0)
+        {
+          TestSend(node, result);
+        }
+        else if (++node->backoffs > PROTOCOL_CSMA_MAX_BACKOFFS)
+        {
+          result->dropped++;
+          node->state = eTestNodeIdle;
+          node->wait = TestInterval();
+        }
+        else
+        {
+          if (node->exponent < PROTOCOL_CSMA_MAX_BE)
+          {
+            node->exponent++;
+          }
+          TestBackoff(node);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+    
+    // Frames on the air at the same time collide.
+    busy = 0;
+    pending = 0;
+    for (i = 0; i < nodes; i++)
+    {
+      busy += (gNodes[i].state == eTestNodeSending);
+      pending += (gNodes[i].generated < TEST_CSMA_FRAMES) || 
+                 (gNodes[i].state != eTestNodeIdle);
+    }
+    for (i = 0; busy > 1 && i < nodes; i++)
+    {
+      if (gNodes[i].state == eTestNodeSending)
+      {
+        gNodes[i].collided = true;
+      }
+    }
+  } while (pending != 0);
+}
+
+int main(void)
+{
+  static const unsigned char nodes[] = {2, 5, 10, 20};
+  struct sTestResult aloha;
+  struct sTestResult csma;
+  unsigned int failures = 0;
+  unsigned char i;
+  
+  printf("nodes  ALOHA collided  CSMA collided  CSMA dropped  (%u frames/node)\n",
+         TEST_CSMA_FRAMES);
+  for (i = 0; i < sizeof(nodes); i++)
+  {
+    TestRun(nodes[i], false, &aloha);
+    TestRun(nodes[i], true, &csma);
+    printf("%5u  %13.1f%%  %12.1f%%  %11.1f%%\n", nodes[i],
+           100.0 * aloha.collided / aloha.sent,
+           100.0 * csma.collided / csma.sent,
+           100.0 * csma.dropped / (nodes[i] * (unsigned long)TEST_CSMA_FRAMES));
+    
+    // The backoff must at least halve the collision rate.
+    if (csma.collided * 2 * aloha.sent > aloha.collided * csma.sent)
+    {
+      printf("FAIL: %u nodes\n", nodes[i]);
+      failures++;
+    }
+  }
+  
+  return (failures == 0) ? 0 : 1;
+}
+
+#endif  /* TEST_FRAME_CSMA */
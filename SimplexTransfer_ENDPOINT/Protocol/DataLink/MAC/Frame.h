@@ -12,8 +12,8 @@
  *  Frame.h - Data Link layer Media Access Control (MAC) framing and scheduling 
  *  sub layer.
  *
- *  @version    1.0.01
- *  @date       16 Oct 2012
+ *  @version    1.0.02
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  This module defines the structure of a frame and a scheduler for the Data
@@ -26,6 +26,7 @@
  *
  *  file dependency
  *  ===============
+ *  API.h : defines PROTOCOL_USE_TIMER
  *  stdbool.h : defines the datatype "bool" which represents values "true" and
  *  "false"
  *  string.h : defines the functions "memcpy", "memcmp", and "memset" that are 
@@ -33,13 +34,41 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.02 : 19 Oct 2026
+ *  - added CSMA/CA channel access for End Point transmissions
+ *  (PROTOCOL_USE_CSMA)
+ *  - added acknowledged End Point data frames with bounded retries
+ *  (PROTOCOL_USE_ACK)
+ *  - added the Gateway beaconed TDMA slot schedule (PROTOCOL_USE_TDMA)
+ *  - added group acknowledgements in the TDMA beacon (PROTOCOL_USE_GROUP_ACK)
+ *  - added per-slot channel hopping over the channel list 
+ *  (PROTOCOL_USE_CHANNEL_AGILITY)
+ *  - added FrameChannelSurvey and the Gateway energy survey of the channel list
+ *  - added per-slot adaptive data rate over the configuration lookup 
+ *  (PROTOCOL_USE_ADR)
+ *  - added closed-loop transmit power control of the transmit slots
+ *  (PROTOCOL_USE_TPC)
+ *  - added the token bucket duty cycle limiter of FrameSend 
+ *  (PROTOCOL_USE_DUTY_CYCLE)
+ *  - added fragmentation of End Point data messages and their reassembly on
+ *  the Gateway (PROTOCOL_USE_FRAGMENTATION)
+ *  - the frame buffer must hold the largest streamed data stream
+ *  (PHY_USE_FIFO_STREAMING)
+ *  - the frame timer follows the public PROTOCOL_USE_TIMER (API.h)
+ *  - the frame buffer reserves the data stream header and footer so that the
+ *  data stream is received in place
+ *  - added FrameFilter
+ *  - the frame may lead with the destination address for hardware filtering
+ *  (PROTOCOL_USE_DESTINATION_FILTER); the configuration states the header
+ *  layout in PROTOCOL_FRAME_HEADER_LAYOUT
  *  ver 1.0.01 : 16 Oct 2012
  *  - updated internal documentation; comments revised
  *  ver 1.0.00 : 17 Sep 2012
  *  - initial release
  */
-#define FRAME_INFO "FRAME 1.0.01"
+#define FRAME_INFO "FRAME 1.0.02"
 
+#include "API.h"
 #include "PhyBridge.h"
 #include "PhyAddress.h"
 
@@ -61,6 +90,31 @@
 #define FRAME_FOOTER_LENGTH         0
 #define FRAME_OVERHEAD_LENGTH       (FRAME_HEADER_LENGTH + FRAME_FOOTER_LENGTH)
 
+// On-air frame header layout: 1 leads with the PAN identifier, 2 leads with
+// the destination address (PROTOCOL_USE_DESTINATION_FILTER). Nodes with
+// different layouts misread each other's frames, so the configuration states
+// the layout it expects in PROTOCOL_FRAME_HEADER_LAYOUT. The End Point and
+// Gateway configurations must use the same value.
+#if defined( PROTOCOL_USE_DESTINATION_FILTER )
+#define FRAME_HEADER_LAYOUT         2
+#else
+#define FRAME_HEADER_LAYOUT         1
+#endif
+
+#ifndef PROTOCOL_FRAME_HEADER_LAYOUT
+#define PROTOCOL_FRAME_HEADER_LAYOUT  1
+#endif
+
+#if (PROTOCOL_FRAME_HEADER_LAYOUT != FRAME_HEADER_LAYOUT)
+#error "Frame Error: PROTOCOL_FRAME_HEADER_LAYOUT does not match PROTOCOL_USE_DESTINATION_FILTER. Change both in the End Point and the Gateway configuration."
+#endif
+
+// The frame buffer receives the data streams. Streamed data streams are only
+// limited by PROTOCOL_DATASTREAM_MAX_SIZE.
+#if defined( PHY_USE_FIFO_STREAMING ) && ((FRAME_OVERHEAD_LENGTH + PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH) < PROTOCOL_DATASTREAM_MAX_SIZE)
+#error "Frame Error: the frame buffer is smaller than PHY_MAX_DATASTREAM_SIZE."
+#endif
+
 #define FRAME_CONTROL_TYPE_MASK         0xC0u
 #define FRAME_CONTROL_SECURE_MASK       0x20u
 #define FRAME_CONTROL_PENDING_MASK      0x10u
@@ -76,12 +130,14 @@
 /**
  *  eFrameType - type indicating the intent of a frame to the scheduler. A Data
  *  frame type contains a message. A Link Request frame type may contain an 
- *  optional message as well as the intent to complete a link.
+ *  optional message as well as the intent to complete a link. A Beacon frame
+ *  type carries the TDMA slot map of a Gateway.
  */
 enum eFrameType
 {
   eFrameTypeData        = 0x00u,        // Data frame
-  eFrameTypeLinkRequest = 0x40u         // Link request frame
+  eFrameTypeLinkRequest = 0x40u,        // Link request frame
+  eFrameTypeBeacon      = 0x80u         // Beacon frame
 };
 
 #define FRAME_CONTROL_TYPE              0xC0u
@@ -92,6 +148,367 @@ enum eFrameType
 #define FRAME_CONTROL_DATA_REQ          0x02u
 #define FRAME_CONTROL_MODE              0x01u
 
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+// Initial backoff exponent (first backoff is 0 to 2^MIN_BE - 1 periods)
+#ifndef PROTOCOL_CSMA_MIN_BE
+#define PROTOCOL_CSMA_MIN_BE            3
+#endif
+
+// Largest backoff exponent
+#ifndef PROTOCOL_CSMA_MAX_BE
+#define PROTOCOL_CSMA_MAX_BE            5
+#endif
+
+// Busy channel assessments tolerated before the frame is dropped
+#ifndef PROTOCOL_CSMA_MAX_BACKOFFS
+#define PROTOCOL_CSMA_MAX_BACKOFFS      4
+#endif
+
+// Length of one backoff period (timer ticks, 1ms)
+#ifndef PROTOCOL_CSMA_BACKOFF_PERIOD
+#define PROTOCOL_CSMA_BACKOFF_PERIOD    10
+#endif
+
+// Time the receiver is on before the clear channel assessment (timer ticks,
+// 1ms). Covers the wake up, calibration and RSSI settling of the radio; the
+// first tick may be partial.
+#ifndef PROTOCOL_CSMA_LISTEN_DELAY
+#define PROTOCOL_CSMA_LISTEN_DELAY      3
+#endif
+
+#if (PROTOCOL_CSMA_MIN_BE > PROTOCOL_CSMA_MAX_BE) || (PROTOCOL_CSMA_MAX_BE > 8)
+#error "Frame Error: Invalid CSMA backoff exponent range."
+#endif
+#endif
+
+#if defined( PROTOCOL_USE_ACK )
+// Retransmissions of an unacknowledged frame
+#ifndef PROTOCOL_ACK_MAX_RETRIES
+#define PROTOCOL_ACK_MAX_RETRIES        3
+#endif
+
+// Gateway processing time allowed on top of the acknowledgement airtime (timer
+// ticks, 1ms)
+#ifndef PROTOCOL_ACK_TURNAROUND
+#define PROTOCOL_ACK_TURNAROUND         20
+#endif
+
+// Retransmission backoff period when CSMA/CA is not used (timer ticks, 1ms)
+#ifndef PROTOCOL_ACK_BACKOFF_PERIOD
+#define PROTOCOL_ACK_BACKOFF_PERIOD     10
+#endif
+
+#if (PROTOCOL_ACK_MAX_RETRIES > 8)
+#error "Frame Error: Too many acknowledgement retries."
+#endif
+#endif
+
+#if defined( PROTOCOL_USE_TDMA )
+// Transmit slots per superframe. This is the maximum number of End Points per
+// Gateway and channel.
+#ifndef PROTOCOL_TDMA_SLOTS
+#define PROTOCOL_TDMA_SLOTS             8
+#endif
+
+// Length of the beacon slot and of each transmit slot (timer ticks, 1ms). A
+// slot must hold the longest frame, its acknowledgement and the guard time.
+#ifndef PROTOCOL_TDMA_SLOT_LENGTH
+#define PROTOCOL_TDMA_SLOT_LENGTH       250
+#endif
+
+// Delay between the start of a slot and the transmission (timer ticks, 1ms)
+#ifndef PROTOCOL_TDMA_GUARD
+#define PROTOCOL_TDMA_GUARD             10
+#endif
+
+/**
+ *  A superframe starts with the beacon slot followed by the transmit slots.
+ *  The beacon payload is,
+ *
+ *           -----------------------------------------------------------------------------------------------
+ *          | Sequence | Slots | Slot Length | Slot Map     | Ack Map      | Blocked | Profiles    | Headroom    |
+ *           -----------------------------------------------------------------------------------------------
+ *    Bytes:     1         1         2       (Slots + 7)/8  (Slots + 7)/8      1     (Slots + 1)/2 (Slots + 1)/2
+ *
+ *  The slot length is sent most significant byte first. Bit (n % 8) of byte
+ *  (n / 8) of the slot map is set if slot n is assigned. The beacon is sent at
+ *  the start of the superframe; an End Point derives the start from the end of
+ *  the beacon and its airtime.
+ *
+ *  The ack map is only sent with PROTOCOL_USE_GROUP_ACK. Its bit n is set if
+ *  the frame sent in slot n during the previous superframe has been received.
+ *
+ *  The blocked channel mask is only sent with PROTOCOL_USE_CHANNEL_AGILITY. Its
+ *  bit n is set if data channel n + 1 of the channel list must not be used
+ *  during the superframe.
+ *
+ *  The profile map is only sent with PROTOCOL_USE_ADR. Bits 4 * (n % 2) to
+ *  4 * (n % 2) + 3 of byte (n / 2) hold the physical configuration (profile)
+ *  that slot n is served with.
+ *
+ *  The headroom map is only sent with PROTOCOL_USE_TPC. Bits 4 * (n % 2) to
+ *  4 * (n % 2) + 3 of byte (n / 2) hold the headroom of the last frame 
+ *  received in slot n, a signed number of 2dB steps (FRAME_TPC_UNKNOWN if no
+ *  frame has been received since the slot was assigned).
+ */
+#define FRAME_TDMA_MAP_SIZE             ((PROTOCOL_TDMA_SLOTS + 7) / 8)
+#if defined( PROTOCOL_USE_GROUP_ACK )
+#define FRAME_TDMA_ACK_MAP_SIZE         FRAME_TDMA_MAP_SIZE
+#else
+#define FRAME_TDMA_ACK_MAP_SIZE         0
+#endif
+#if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+#define FRAME_TDMA_BLOCKED_SIZE         1
+#else
+#define FRAME_TDMA_BLOCKED_SIZE         0
+#endif
+#if defined( PROTOCOL_USE_ADR )
+#define FRAME_TDMA_PROFILE_MAP_SIZE     ((PROTOCOL_TDMA_SLOTS + 1) / 2)
+#else
+#define FRAME_TDMA_PROFILE_MAP_SIZE     0
+#endif
+#if defined( PROTOCOL_USE_TPC )
+#define FRAME_TDMA_HEADROOM_MAP_SIZE    ((PROTOCOL_TDMA_SLOTS + 1) / 2)
+#else
+#define FRAME_TDMA_HEADROOM_MAP_SIZE    0
+#endif
+#define FRAME_TDMA_BLOCKED_OFFSET       (4 + FRAME_TDMA_MAP_SIZE + FRAME_TDMA_ACK_MAP_SIZE)
+#define FRAME_TDMA_PROFILE_OFFSET       (FRAME_TDMA_BLOCKED_OFFSET + FRAME_TDMA_BLOCKED_SIZE)
+#define FRAME_TDMA_HEADROOM_OFFSET      (FRAME_TDMA_PROFILE_OFFSET + FRAME_TDMA_PROFILE_MAP_SIZE)
+#define FRAME_TDMA_BEACON_LENGTH        (FRAME_TDMA_HEADROOM_OFFSET + FRAME_TDMA_HEADROOM_MAP_SIZE)
+#define FRAME_TDMA_SUPERFRAME           (PROTOCOL_TDMA_SLOT_LENGTH * (PROTOCOL_TDMA_SLOTS + 1UL))
+#define FRAME_TDMA_NO_SLOT              0xFFu
+
+#if (PROTOCOL_TDMA_SLOTS < 1) || (PROTOCOL_TDMA_SLOTS >= FRAME_TDMA_NO_SLOT)
+#error "Frame Error: Invalid number of TDMA slots."
+#endif
+
+#if (FRAME_TDMA_BEACON_LENGTH > PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH)
+#error "Frame Error: TDMA beacon does not fit in the frame payload."
+#endif
+
+#if (PROTOCOL_TDMA_GUARD >= PROTOCOL_TDMA_SLOT_LENGTH)
+#error "Frame Error: TDMA guard time must be shorter than a slot."
+#endif
+
+#if defined( PROTOCOL_USE_GROUP_ACK ) && !defined( PROTOCOL_USE_ACK )
+#error "Frame Error: Group acknowledgements require PROTOCOL_USE_ACK."
+#endif
+
+// An End Point waits up to two superframes for a beacon.
+#if ((2 * FRAME_TDMA_SUPERFRAME) > 0xFFFFu)
+#error "Frame Error: TDMA superframe is too long."
+#endif
+
+#if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+/**
+ *  The first channel of the channel list is the control channel. It carries
+ *  beacons, link requests and frames sent with contention access. The other 
+ *  channels are data channels: slot n uses data channel (n % m) of the m data
+ *  channels that are not blocked, so the End Points of a Gateway are spread
+ *  over the data channels. The Gateway tunes to the channel of each slot.
+ */
+#define FRAME_CHANNEL_DATA_COUNT        (PROTOCOL_CHANNEL_LIST_SIZE - 1)
+#define FRAME_CHANNEL_DATA_MASK         ((1u << FRAME_CHANNEL_DATA_COUNT) - 1)
+#define FRAME_CHANNEL_CONTROL           0
+
+// Reception errors on a data channel before the Gateway blocks it
+#ifndef PROTOCOL_CHANNEL_ERROR_LIMIT
+#define PROTOCOL_CHANNEL_ERROR_LIMIT    4
+#endif
+
+// Superframes before the blocked data channels are used again
+#ifndef PROTOCOL_CHANNEL_BLOCK_PERIOD
+#define PROTOCOL_CHANNEL_BLOCK_PERIOD   64
+#endif
+
+// Superframes between energy surveys of the channel list (0: at startup only).
+// A survey measures one channel per beacon.
+#ifndef PROTOCOL_CHANNEL_SURVEY_PERIOD
+#define PROTOCOL_CHANNEL_SURVEY_PERIOD  32
+#endif
+
+// Energy above the quietest data channel at which a data channel is blocked (dB)
+#ifndef PROTOCOL_CHANNEL_ENERGY_MARGIN
+#define PROTOCOL_CHANNEL_ENERGY_MARGIN  10
+#endif
+
+#if (PROTOCOL_CHANNEL_LIST_SIZE < 2) || (PROTOCOL_CHANNEL_LIST_SIZE > 9)
+#error "Frame Error: Channel agility requires a control channel and 1 to 8 data channels."
+#endif
+#endif
+
+#if defined( PROTOCOL_USE_ADR )
+/**
+ *  Profile n is entry n of the physical configuration lookup. The profiles
+ *  must be ordered from the most robust (slowest) to the fastest; profile 0 is
+ *  the base profile. PROTOCOL_ADR_SENSITIVITY lists the receiver sensitivity 
+ *  (dBm) of each profile, for example "-111, -102, -97, -90".
+ */
+#ifndef PROTOCOL_ADR_PROFILES
+#error "Frame Error: PROTOCOL_ADR_PROFILES must list the number of physical configurations."
+#endif
+
+#ifndef PROTOCOL_ADR_SENSITIVITY
+#error "Frame Error: PROTOCOL_ADR_SENSITIVITY must list the sensitivity of each physical configuration."
+#endif
+
+// RSSI required above the sensitivity of a profile to serve a slot with it (dB)
+#ifndef PROTOCOL_ADR_MARGIN
+#define PROTOCOL_ADR_MARGIN             10
+#endif
+
+#if (PROTOCOL_ADR_PROFILES < 2) || (PROTOCOL_ADR_PROFILES > 16)
+#error "Frame Error: Adaptive data rate requires 2 to 16 physical configurations."
+#endif
+
+#if !defined( PROTOCOL_USE_ACK )
+#error "Frame Error: Adaptive data rate requires PROTOCOL_USE_ACK."
+#endif
+
+#define FRAME_ADR_BASE                  0
+#define FRAME_ADR_NO_RSSI               127
+#endif
+
+#if defined( PROTOCOL_USE_TPC )
+/**
+ *  The headroom of a frame is its RSSI above the sensitivity of the profile of
+ *  its slot plus PROTOCOL_TPC_MARGIN. Without PROTOCOL_USE_ADR, 
+ *  PROTOCOL_TPC_SENSITIVITY is the receiver sensitivity (dBm) of the 
+ *  configuration. Only the Gateway measures the headroom.
+ */
+#if defined( PROTOCOL_GATEWAY ) && !defined( PROTOCOL_USE_ADR ) && !defined( PROTOCOL_TPC_SENSITIVITY )
+#error "Frame Error: PROTOCOL_TPC_SENSITIVITY must be the sensitivity of the physical configuration."
+#endif
+
+// RSSI kept above the sensitivity of the profile of a slot (dB)
+#ifndef PROTOCOL_TPC_MARGIN
+#define PROTOCOL_TPC_MARGIN             10
+#endif
+
+// Headroom at which an End Point lowers its output power (dB)
+#ifndef PROTOCOL_TPC_HYSTERESIS
+#define PROTOCOL_TPC_HYSTERESIS         4
+#endif
+
+// A slot kept at PROTOCOL_TPC_MARGIN must still keep the adaptive data rate
+// margin of its profile, otherwise the profile and the power would oscillate.
+#if defined( PROTOCOL_USE_ADR ) && (PROTOCOL_TPC_MARGIN < PROTOCOL_ADR_MARGIN)
+#error "Frame Error: The power control margin must not be below the adaptive data rate margin."
+#endif
+
+#if !defined( PROTOCOL_USE_ACK )
+#error "Frame Error: Transmit power control requires PROTOCOL_USE_ACK."
+#endif
+
+#define FRAME_TPC_STEP                  2       // Headroom step (dB)
+#define FRAME_TPC_UNKNOWN               (-8)    // No frame received in the slot
+#define FRAME_TPC_HIGHEST               127     // Requests the highest output power (dBm)
+
+#if (PROTOCOL_TPC_HYSTERESIS < FRAME_TPC_STEP)
+#error "Frame Error: The power control hysteresis must be at least one headroom step."
+#endif
+#endif
+
+// The Gateway serves each transmit slot with its own channel or profile.
+#if defined( PROTOCOL_USE_CHANNEL_AGILITY ) || defined( PROTOCOL_USE_ADR )
+#define FRAME_TDMA_HOPPING
+#endif
+#elif defined( PROTOCOL_USE_GROUP_ACK )
+#error "Frame Error: Group acknowledgements require PROTOCOL_USE_TDMA."
+#elif defined( PROTOCOL_USE_CHANNEL_AGILITY )
+#error "Frame Error: Channel agility requires PROTOCOL_USE_TDMA."
+#elif defined( PROTOCOL_USE_ADR )
+#error "Frame Error: Adaptive data rate requires PROTOCOL_USE_TDMA."
+#elif defined( PROTOCOL_USE_TPC )
+#error "Frame Error: Transmit power control requires PROTOCOL_USE_TDMA."
+#endif
+
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+/**
+ *  The airtime of every frame sent is drawn from a token bucket refilled at
+ *  (1 - 2^-PROTOCOL_DUTY_CYCLE_BURST) of the duty cycle of the configuration.
+ *  The bucket holds 2^-PROTOCOL_DUTY_CYCLE_BURST of the airtime allowed over
+ *  PROTOCOL_DUTY_CYCLE_WINDOW, so no window of that length carries more than 
+ *  the allowed airtime. Configurations without duty cycle requirement are not
+ *  limited.
+ */
+// Observation window of the duty cycle (seconds)
+#ifndef PROTOCOL_DUTY_CYCLE_WINDOW
+#define PROTOCOL_DUTY_CYCLE_WINDOW      3600
+#endif
+
+// Share of the window airtime that may be sent in a burst (2^-n)
+#ifndef PROTOCOL_DUTY_CYCLE_BURST
+#define PROTOCOL_DUTY_CYCLE_BURST       3
+#endif
+
+#if (PROTOCOL_DUTY_CYCLE_WINDOW < 1) || (PROTOCOL_DUTY_CYCLE_WINDOW > 4000)
+#error "Frame Error: The duty cycle window must be 1 to 4000 seconds."
+#endif
+
+#if (PROTOCOL_DUTY_CYCLE_BURST < 1) || (PROTOCOL_DUTY_CYCLE_BURST > 8)
+#error "Frame Error: The duty cycle burst share must be 2^-1 to 2^-8."
+#endif
+
+// A Gateway is not credited by the application (ProtocolEngineElapsed); the 
+// frame timer refills its bucket. Only the beacon schedule keeps it running.
+#if defined( PROTOCOL_GATEWAY ) && !defined( PROTOCOL_USE_TDMA )
+#error "Frame Error: A Gateway duty cycle limiter requires PROTOCOL_USE_TDMA."
+#endif
+#endif
+
+#if defined( PROTOCOL_USE_FRAGMENTATION )
+/**
+ *  End Point data frames start with a fragment header holding the index of the
+ *  fragment in its message. A data message that does not fit into one frame is
+ *  sent as a sequence of fragments; all fragments but the last one have the
+ *  pending control bit set. The Gateway reassembles the fragments of each
+ *  source in a buffer of its own and passes up complete messages only.
+ */
+// Reassembly buffers (sources sending a fragmented message at the same time)
+#ifndef PROTOCOL_FRAGMENT_BUFFERS
+#define PROTOCOL_FRAGMENT_BUFFERS       2
+#endif
+
+// Longest message the Gateway reassembles (bytes)
+#ifndef PROTOCOL_FRAGMENT_MAX_LENGTH
+#define PROTOCOL_FRAGMENT_MAX_LENGTH    64
+#endif
+
+// Time the Gateway waits for the next fragment of a message (timer ticks, 1ms)
+#ifndef PROTOCOL_FRAGMENT_TIMEOUT
+#if defined( PROTOCOL_USE_TDMA ) && defined( PROTOCOL_USE_ACK )
+// The next fragment waits for the next beacon; allow for its retransmissions.
+#define PROTOCOL_FRAGMENT_TIMEOUT       ((PROTOCOL_ACK_MAX_RETRIES + 3) * FRAME_TDMA_SUPERFRAME)
+#elif defined( PROTOCOL_USE_TDMA )
+#define PROTOCOL_FRAGMENT_TIMEOUT       (3 * FRAME_TDMA_SUPERFRAME)
+#else
+#define PROTOCOL_FRAGMENT_TIMEOUT       2000
+#endif
+#endif
+
+#define FRAME_FRAGMENT_HEADER_LENGTH    1
+#define FRAME_FRAGMENT_PAYLOAD_LENGTH   (PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH - FRAME_FRAGMENT_HEADER_LENGTH)
+
+#if (PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH <= FRAME_FRAGMENT_HEADER_LENGTH)
+#error "Frame Error: The frame payload does not hold a fragment."
+#endif
+
+#if (PROTOCOL_FRAGMENT_BUFFERS < 1) || (PROTOCOL_FRAGMENT_MAX_LENGTH > 255)
+#error "Frame Error: Invalid reassembly buffers."
+#endif
+
+#if (PROTOCOL_FRAGMENT_TIMEOUT < 1) || (PROTOCOL_FRAGMENT_TIMEOUT > 0xFFFFu)
+#error "Frame Error: The reassembly timeout must be 1 to 65535 timer ticks."
+#endif
+#endif
+
+// The frame timer runs on the generic physical timer (see PROTOCOL_USE_TIMER).
+#if defined( PROTOCOL_USE_TIMER )
+#define FRAME_USE_TIMER
+#endif
+
 /**
  *  sFrame - represents a Data Link layer frame.
  *
@@ -113,6 +530,11 @@ enum eFrameType
  *      Payload     Message being encapsulated in the frame.
  *  
  *  Note: The PAN ID, Destination, Source, and Payload sizes are configurable.
+ *
+ *  Note: With PROTOCOL_USE_DESTINATION_FILTER, the Destination comes before
+ *  the PAN ID (header layout 2). The Physical hardware filters on the first 
+ *  byte of the data field, so frames for other nodes are dropped by the radio.
+ *  This changes the frame on air; it is not understood by nodes using layout 1.
  */
 struct sFrame
 {
@@ -121,8 +543,13 @@ struct sFrame
    */
   struct sFrameHeader
   {
+    #if defined( PROTOCOL_USE_DESTINATION_FILTER )
+    unsigned char destAddr[PROTOCOL_PHYADDRESS_ADDRESS_SIZE]; // Destination for the payload
+    unsigned char panId[PROTOCOL_PHYADDRESS_PANID_SIZE];
+    #else
     unsigned char panId[PROTOCOL_PHYADDRESS_PANID_SIZE];
     unsigned char destAddr[PROTOCOL_PHYADDRESS_ADDRESS_SIZE]; // Destination for the payload
+    #endif
     unsigned char srcAddr[PROTOCOL_PHYADDRESS_ADDRESS_SIZE];  // Source of the payload
     /**
      *  sFrameControl - control information used by the scheduler to determine
@@ -156,6 +583,257 @@ struct sFrameDataResponse
   unsigned char length;     // Number of bytes in the response
 };
 
+/**
+ *  eFrameTimerEvent - operation performed when the frame timer expires.
+ */
+enum eFrameTimerEvent
+{
+  eFrameTimerIdle     = 0x00u,  // Timer not used
+  eFrameTimerBackoff  = 0x01u,  // Send the pending frame
+  eFrameTimerAck      = 0x02u,  // Acknowledgement window elapsed
+  eFrameTimerBeacon   = 0x03u,  // Send a beacon (Gateway) or beacon missed (End Point)
+  eFrameTimerSlot     = 0x04u,  // Transmit slot reached (End Point) or next slot (Gateway hopping)
+  eFrameTimerResponse = 0x05u,  // Response window elapsed
+  eFrameTimerWake     = 0x06u,  // Listen for the beacon carrying the group acknowledgement
+  eFrameTimerCca      = 0x07u   // Receiver settled for the clear channel assessment
+};
+
+/**
+ *  sFrameTimer - frame timer.
+ */
+struct sFrameTimer
+{
+  volatile unsigned int delay;    // Remaining time (timer ticks)
+  enum eFrameTimerEvent event;    // Operation performed on expiry
+  unsigned int random;            // Backoff pseudo-random generator state
+};
+
+/**
+ *  sFrameCsma - carrier sense multiple access with collision avoidance
+ *  (CSMA/CA) state of the frame being sent.
+ *
+ *  Note: This should only be used by an End Point node.
+ */
+struct sFrameCsma
+{
+  unsigned char backoffs;   // Busy channel assessments for the current frame
+  unsigned char exponent;   // Current backoff exponent
+  unsigned int busyCount;   // Busy channel assessments (statistics)
+  unsigned int failures;    // Frames dropped due to a busy channel (statistics)
+};
+
+/**
+ *  sFrameAck - acknowledgement state.
+ *
+ *  An End Point keeps a copy of the unacknowledged frame (the frame buffer is
+ *  shared with reception). A Gateway remembers the last acknowledged frame to
+ *  filter retransmissions whose acknowledgement was lost.
+ */
+struct sFrameAck
+{
+  #if defined( PROTOCOL_ENDPOINT )
+  bool waiting;             // Waiting for an acknowledgement
+  unsigned char retries;    // Retransmissions of the current frame
+  struct sFrame frame;      // Copy of the unacknowledged frame
+  unsigned char length;     // Payload length of the unacknowledged frame
+  unsigned int failures;    // Frames never acknowledged (statistics)
+  #elif defined( PROTOCOL_GATEWAY )
+  bool valid;               // An acknowledged frame has been recorded
+  unsigned char srcAddr[PROTOCOL_PHYADDRESS_ADDRESS_SIZE];  // Source of the last acknowledged frame
+  unsigned char seqNumber;  // Sequence number of the last acknowledged frame
+  #endif
+};
+
+#if defined( PROTOCOL_USE_TDMA )
+/**
+ *  sFrameTdma - time division multiple access (TDMA) state.
+ *
+ *  A Gateway assigns a transmit slot to every End Point that links to it and
+ *  broadcasts the slot map in a beacon at the start of each superframe. Slots
+ *  are released when the Gateway restarts.
+ *
+ *  A linked End Point sends its data frames in its slot. For each frame it
+ *  listens for the next beacon, sleeps until the slot starts and transmits
+ *  after the guard time. Link requests are sent with contention access.
+ *
+ *  With group acknowledgements the Gateway does not acknowledge frames sent in
+ *  a slot. It collects them over the superframe and acknowledges them all in
+ *  the ack map of the next beacon; the End Point sleeps until that beacon.
+ *  Frames sent with contention access are still acknowledged immediately.
+ */
+struct sFrameTdma
+{
+  #if defined( PROTOCOL_ENDPOINT )
+  bool waiting;             // Waiting for a beacon
+  unsigned char slot;       // Assigned slot (FRAME_TDMA_NO_SLOT if none)
+  unsigned char sequence;   // Sequence number of the last beacon
+  unsigned char slots;      // Slots per superframe (last beacon)
+  unsigned int slotLength;  // Slot length (last beacon)
+  struct sFrame frame;      // Copy of the frame waiting for the slot
+  unsigned char length;     // Payload length of the frame waiting for the slot
+  unsigned int dropped;     // Frames dropped without a usable slot (statistics)
+  #elif defined( PROTOCOL_GATEWAY )
+  bool transmitting;        // A frame is being sent
+  unsigned char sequence;   // Beacon sequence number
+  unsigned char map[FRAME_TDMA_MAP_SIZE]; // Assigned slots
+  unsigned char owner[PROTOCOL_TDMA_SLOTS][PROTOCOL_PHYADDRESS_ADDRESS_SIZE]; // Slot owners
+  #if defined( PROTOCOL_USE_GROUP_ACK )
+  unsigned char acked[FRAME_TDMA_MAP_SIZE];   // Slots received in this superframe
+  unsigned char seen[FRAME_TDMA_MAP_SIZE];    // Slots with a valid sequence number
+  unsigned char seqNumber[PROTOCOL_TDMA_SLOTS]; // Sequence number of the last frame per slot
+  #endif
+  #if defined( FRAME_TDMA_HOPPING )
+  unsigned char current;    // Next slot to tune to (PROTOCOL_TDMA_SLOTS: beacon)
+  #endif
+  #endif
+};
+#endif
+
+#if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+/**
+ *  sFrameChannel - channel agility state.
+ *
+ *  An End Point learns its home channel from its slot and the blocked channel
+ *  mask (link request response and beacons). A Gateway counts the reception
+ *  errors on each data channel; a channel that reaches
+ *  PROTOCOL_CHANNEL_ERROR_LIMIT is blocked from the next beacon on, which moves
+ *  its End Points to the remaining data channels. The Gateway also measures the
+ *  energy on the channel list at startup and every 
+ *  PROTOCOL_CHANNEL_SURVEY_PERIOD superframes; data channels that are
+ *  PROTOCOL_CHANNEL_ENERGY_MARGIN above the quietest one are blocked as well.
+ */
+struct sFrameChannel
+{
+  unsigned char list[PROTOCOL_CHANNEL_LIST_SIZE]; // Channel list (control channel first)
+  unsigned char current;    // Channel list index the radio is tuned to
+  unsigned char blocked;    // Blocked data channels (current superframe)
+  #if defined( PROTOCOL_GATEWAY )
+  unsigned char pending;    // Blocked data channels (from the next beacon)
+  unsigned char age;        // Superframes since a data channel was blocked
+  unsigned char errors[FRAME_CHANNEL_DATA_COUNT]; // Reception errors per data channel
+  unsigned char survey;     // Superframes since the last energy survey
+  unsigned char sweep;      // Next channel list index of the survey (list size: none)
+  tPower energy[PROTOCOL_CHANNEL_LIST_SIZE];      // Energy per channel (last survey)
+  #endif
+  unsigned int migrations;  // Data channels blocked (Gateway) or home channel changes (End Point)
+};
+#endif
+
+#if defined( PROTOCOL_USE_ADR )
+/**
+ *  sFrameAdr - adaptive data rate (ADR) state.
+ *
+ *  Beacons, link requests and frames sent with contention access use the base
+ *  profile. Each transmit slot is served with its own profile, which is sent
+ *  in the beacon. The Gateway averages the RSSI of the frames received in a
+ *  slot and serves the slot with the fastest profile whose sensitivity is
+ *  PROTOCOL_ADR_MARGIN below that average.
+ *
+ *  An End Point whose frame is dropped in a slot served with a faster profile
+ *  falls back to contention access (base profile) until a beacon lowers the
+ *  profile of its slot. The Gateway lowers the profile of a slot when it
+ *  receives such a frame; the slot is not moved above that profile again.
+ */
+struct sFrameAdr
+{
+  unsigned char current;    // Profile the radio is configured with
+  #if defined( PROTOCOL_ENDPOINT )
+  unsigned char profile;    // Profile of the transmit slot (last beacon)
+  bool fallback;            // Frames are sent with contention access
+  unsigned int fallbacks;   // Frames dropped with a faster profile (statistics)
+  #elif defined( PROTOCOL_GATEWAY )
+  unsigned char profile[PROTOCOL_TDMA_SLOTS]; // Profile per slot
+  unsigned char limit[PROTOCOL_TDMA_SLOTS];   // Fastest profile allowed per slot
+  signed char rssi[PROTOCOL_TDMA_SLOTS];      // Averaged RSSI per slot (dBm)
+  unsigned int changes;     // Slot profile changes (statistics)
+  #endif
+};
+#endif
+
+#if defined( PROTOCOL_USE_TPC )
+/**
+ *  sFrameTpc - transmit power control (TPC) state.
+ *
+ *  The Gateway sends the headroom of each transmit slot in the beacon. An End
+ *  Point whose slot frame has been acknowledged lowers the output power of its
+ *  slot by the headroom once it reaches PROTOCOL_TPC_HYSTERESIS, and raises it
+ *  by the missing margin when the headroom is negative. The output power 
+ *  changes at most once per frame sent in the slot.
+ *
+ *  A frame that is not acknowledged is retried at the highest output power.
+ *  Frames sent with contention access use the highest output power.
+ */
+struct sFrameTpc
+{
+  #if defined( PROTOCOL_ENDPOINT )
+  tPower power;             // Output power of the transmit slot (dBm)
+  tPower maximum;           // Highest output power (dBm)
+  bool reported;            // The headroom reflects the output power of the slot
+  unsigned int changes;     // Output power changes (statistics)
+  #elif defined( PROTOCOL_GATEWAY )
+  signed char headroom[PROTOCOL_TDMA_SLOTS];  // Headroom per slot (steps)
+  #endif
+};
+#endif
+
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+/**
+ *  sFrameDutyCycle - duty cycle limiter state.
+ *
+ *  One millisecond of airtime is worth 1000 * 2^PROTOCOL_DUTY_CYCLE_BURST 
+ *  tokens. Acknowledgements, beacons and retransmissions are not held back;
+ *  their airtime may put the bucket into debt, which delays the next frames
+ *  handed to FrameSend.
+ */
+struct sFrameDutyCycle
+{
+  signed long tokens;       // Airtime available (may be negative)
+  unsigned int denied;      // Frames refused by FrameSend (statistics)
+};
+#endif
+
+#if defined( PROTOCOL_USE_FRAGMENTATION )
+/**
+ *  sFrameReassembly - reassembly buffer of a fragmented message.
+ *
+ *  Note: This should only be used by a Gateway node.
+ */
+struct sFrameReassembly
+{
+  unsigned char srcAddr[PROTOCOL_PHYADDRESS_ADDRESS_SIZE];  // Source of the message
+  unsigned char index;      // Index of the next fragment
+  unsigned char length;     // Bytes of the message received
+  unsigned int timeout;     // Time left for the next fragment (0: buffer free)
+  unsigned char data[PROTOCOL_FRAGMENT_MAX_LENGTH];         // Message
+};
+
+/**
+ *  sFrameFragment - fragmentation state.
+ *
+ *  An End Point sends the next fragment of a message once the previous one has
+ *  completed (sent or acknowledged). A message whose fragment is dropped is not
+ *  completed. The payload of the message is read while it is sent; it must not
+ *  change until the transfer completes.
+ *
+ *  A Gateway discards a message once a fragment is missing, the message does
+ *  not fit into its buffer or no fragment has been received for
+ *  PROTOCOL_FRAGMENT_TIMEOUT. Without a free buffer the message closest to its
+ *  timeout is discarded.
+ */
+struct sFrameFragment
+{
+  #if defined( PROTOCOL_ENDPOINT )
+  unsigned char *payload;   // Rest of the message
+  unsigned char remaining;  // Bytes of the message not sent yet
+  unsigned char index;      // Index of the fragment being sent
+  bool dataRequest;         // The last fragment requests data
+  #elif defined( PROTOCOL_GATEWAY )
+  struct sFrameReassembly buffer[PROTOCOL_FRAGMENT_BUFFERS];  // Reassembly buffers
+  unsigned int discarded;   // Incomplete messages discarded (statistics)
+  #endif
+};
+#endif
+
 /**
  *  sFrameScheduler - Media Access Control (MAC) scheduler information.
  */
@@ -205,13 +883,48 @@ struct sFrameScheduler
   struct sFrameDataResponse dataResponse; // Data request response information
   #endif
   
+  #if defined( FRAME_USE_TIMER )
+  struct sFrameTimer timer;       // Backoff, acknowledgement and slot timer
+  #endif
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+  struct sFrameCsma csma;         // Channel access state
+  #endif
+  #if defined( PROTOCOL_USE_ACK )
+  struct sFrameAck ack;           // Acknowledgement state
+  #endif
+  #if defined( PROTOCOL_USE_TDMA )
+  struct sFrameTdma tdma;         // Slot schedule
+  #endif
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  struct sFrameChannel channel;   // Channel agility
+  #endif
+  #if defined( PROTOCOL_USE_ADR )
+  struct sFrameAdr adr;           // Adaptive data rate
+  #endif
+  #if defined( PROTOCOL_USE_TPC )
+  struct sFrameTpc tpc;           // Transmit power control
+  #endif
+  #if defined( PROTOCOL_USE_DUTY_CYCLE )
+  struct sFrameDutyCycle duty;    // Duty cycle limiter
+  #endif
+  #if defined( PROTOCOL_USE_FRAGMENTATION )
+  struct sFrameFragment fragment; // Fragmentation and reassembly
+  #endif
+  
   // --------------------------------------------------------------------------
   // Frame scheduler resources
   
   volatile bool busy;             // Frame scheduler busy flag
   volatile bool txBusy;           // Frame transmit busy flag
   volatile bool rxBusy;           // Frame receive busy flag
+  
+  /**
+   *  The data stream is received in place around the frame (see PhyReceiverOn).
+   *  The frame is only made of bytes; the members are not padded.
+   */
+  unsigned char streamHeader[PROTOCOL_DATASTREAM_HEADER_LENGTH];  // Data stream length field (RX)
   struct sFrame frame;            // Frame for RX/TX
+  unsigned char streamFooter[PROTOCOL_DATASTREAM_FOOTER_LENGTH];  // Data stream status (RX)
   unsigned char length;           // Frame length in bytes
 };
 
@@ -284,7 +997,13 @@ bool FrameListen(void);
 
 /**
  *  FrameSend - send a frame to the destination. Use FrameBuild(...) to 
- *  construct the frame.
+ *  construct the frame. With PROTOCOL_USE_DUTY_CYCLE the frame is refused 
+ *  while the duty cycle limiter does not hold its airtime.
+ *
+ *  With PROTOCOL_USE_FRAGMENTATION an End Point data message longer than one
+ *  frame is sent as a sequence of fragments. The payload buffer is read until
+ *  the transfer completes; the duty cycle limiter must hold the airtime of all
+ *  fragments.
  *
  *    @param  type      Type of frame being constructed.
  *    @param  payload   Buffer holding the frame payload.
@@ -306,6 +1025,24 @@ bool FrameSend(enum eFrameType type,
  */
 bool FrameBusy(void);
 
+/**
+ *  FrameFilter - reject an incoming frame as soon as its header is received. 
+ *  The frame header goes through the same address, PAN identifier and mode
+ *  checks as FrameAssemble so a frame for another node or PAN is flushed by the
+ *  Physical layer instead of being read. A frame longer than the frame buffer
+ *  is rejected as well.
+ *
+ *  Note: It is assumed that this function is called from inside a critical
+ *  region. Physical device interrupts should be disabled when entering/exiting 
+ *  this function.
+ *
+ *    @param  dataField Buffer containing the received frame header.
+ *    @param  length    Length of the data field.
+ *
+ *    @return True if the rest of the frame must be received.
+ */
+bool FrameFilter(unsigned char *dataField, unsigned char length);
+
 /**
  *  FrameAssemble - assemble the incoming data streams into a complete frame.
  *  Once a complete frame is created, send a notification to the layer above.
@@ -347,4 +1084,125 @@ unsigned char FrameDisassemble(void);
  */
 unsigned char FrameTimeout(void);
 
+#if defined( FRAME_USE_TIMER )
+/**
+ *  FrameTimer - generic timer callback that counts down the frame timer. When
+ *  a backoff expires the pending frame is sent. When an acknowledgement window
+ *  expires the frame is retransmitted or dropped. With TDMA a Gateway sends its
+ *  beacons and an End Point sends its frame when its slot is reached. A Gateway
+ *  also ages its reassembly buffers.
+ *
+ *    @return Status message from caller (currently not being used for frame
+ *            use).
+ */
+unsigned char FrameTimer(void);
+#endif
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+/**
+ *  FrameGetCsmaInfo - get the CSMA/CA state and statistics.
+ *
+ *    @return Location of the channel access information.
+ */
+const struct sFrameCsma* FrameGetCsmaInfo(void);
+#endif
+
+#if defined( PROTOCOL_USE_ACK )
+/**
+ *  FrameGetAckInfo - get the acknowledgement state and statistics.
+ *
+ *    @return Location of the acknowledgement information.
+ */
+const struct sFrameAck* FrameGetAckInfo(void);
+#endif
+
+#if defined( PROTOCOL_USE_TDMA )
+/**
+ *  FrameGetTdmaInfo - get the TDMA slot schedule and statistics.
+ *
+ *    @return Location of the TDMA information.
+ */
+const struct sFrameTdma* FrameGetTdmaInfo(void);
+#endif
+
+/**
+ *  FrameChannelSurvey - measure the energy on every approved channel and rank
+ *  the quietest channels (see PhyScanChannels). Reception is suspended and the
+ *  frame timer is held during the survey.
+ *
+ *    @param  channel Ranked channels, quietest first.
+ *    @param  power   Energy measured on each ranked channel.
+ *    @param  count   Number of entries available in channel and power.
+ *
+ *    @return Number of ranked channels. Zero if an End Point is busy or a 
+ *            Gateway is sending a frame.
+ */
+unsigned char FrameChannelSurvey(unsigned char *channel, 
+                                 tPower *power, 
+                                 unsigned char count);
+
+#if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+/**
+ *  FrameSetChannelList - set the channel list used for channel agility. The 
+ *  radio is tuned to the first (control) channel.
+ *
+ *  Note: This must be called before FrameInit.
+ *
+ *    @param  channel   PROTOCOL_CHANNEL_LIST_SIZE channels.
+ */
+void FrameSetChannelList(const unsigned char *channel);
+
+/**
+ *  FrameGetChannelInfo - get the channel agility state and statistics.
+ *
+ *    @return Location of the channel agility information.
+ */
+const struct sFrameChannel* FrameGetChannelInfo(void);
+#endif
+
+#if defined( PROTOCOL_USE_ADR )
+/**
+ *  FrameGetAdrInfo - get the adaptive data rate state and statistics.
+ *
+ *    @return Location of the adaptive data rate information.
+ */
+const struct sFrameAdr* FrameGetAdrInfo(void);
+#endif
+
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+/**
+ *  FrameDutyCycleElapsed - credit the duty cycle limiter with time that has
+ *  elapsed while the physical timer was stopped. The ticks of the physical 
+ *  timer are credited by the frame scheduler.
+ *
+ *    @param  elapsed   Elapsed time (milliseconds).
+ */
+void FrameDutyCycleElapsed(unsigned int elapsed);
+
+/**
+ *  FrameGetDutyCycleInfo - get the duty cycle limiter state and statistics.
+ *
+ *    @return Location of the duty cycle limiter information.
+ */
+const struct sFrameDutyCycle* FrameGetDutyCycleInfo(void);
+#endif
+
+#if defined( PROTOCOL_USE_TPC )
+/**
+ *  FrameGetTpcInfo - get the transmit power control state and statistics.
+ *
+ *    @return Location of the transmit power control information.
+ */
+const struct sFrameTpc* FrameGetTpcInfo(void);
+#endif
+
+#if defined( PROTOCOL_USE_FRAGMENTATION )
+/**
+ *  FrameGetFragmentInfo - get the fragmentation state and statistics.
+ *
+ *    @return Location of the fragmentation information.
+ */
+const struct sFrameFragment* FrameGetFragmentInfo(void);
+#endif
+
 #endif  /* FRAME_H */
@@ -9,8 +9,8 @@
  *
  *  PhyAddress.c - Data Link layer physical addressing.
  *
- *  @version    1.0.00
- *  @date       17 Sep 2012
+ *  @version    1.0.01
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  For details on the interface, please see PhyAddress.h.
@@ -28,6 +28,9 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.01 : 19 Oct 2026
+ *  - the hardware address filter may use the local address instead of the
+ *  PAN identifier (PROTOCOL_USE_DESTINATION_FILTER)
  *  ver 1.0.00 : 17 Sep 2012
  *  - initial release
  */
@@ -100,6 +103,12 @@ void PhyAddressInit(const unsigned char panId[PHY_ADDRESS_PANID_SIZE],
                  address,
                  PHY_ADDRESS_ADDRESS_SIZE);
   
+  #if defined( PROTOCOL_USE_DESTINATION_FILTER )
+  // Set device address for physical filtering. Physical filtering is based off
+  // of the local address (lowest byte), which is known before any link exists.
+  // Frames to the broadcast address are also accepted.
+  PhyEnableAddressFilter(gPhyAddressInfo.local.address[0]);
+  #else
   #if defined( PROTOCOL_ENDPOINT )
   if (gPhyAddressInfo.local.fixed)
   {
@@ -115,6 +124,7 @@ void PhyAddressInit(const unsigned char panId[PHY_ADDRESS_PANID_SIZE],
     PhyDisableAddressFilter();
   }
   #endif
+  #endif
 }
 
 // -----------------------------------------------------------------------------
@@ -167,9 +177,11 @@ void PhyAddressLinkEstablish(unsigned char panId[PHY_ADDRESS_PANID_SIZE],
   {
     PhyAddressCopy(gPhyAddressInfo.local.panId, panId, PHY_ADDRESS_PANID_SIZE);
     
+    #if !defined( PROTOCOL_USE_DESTINATION_FILTER )
     // Set device address for physical filtering. Physical filtering is based off
     // of the PAN identifier (lowest byte).
     PhyEnableAddressFilter(gPhyAddressInfo.local.panId[0]);
+    #endif
   }
   PhyAddressCopy(gPhyAddressInfo.local.remote, remote, PHY_ADDRESS_ADDRESS_SIZE);
 
@@ -191,8 +203,10 @@ void PhyAddressLinkDestroy()
     // Set PAN identifier to broadcast address.
     PhyAddressToBroadcast(gPhyAddressInfo.local.panId, PHY_ADDRESS_PANID_SIZE);
     
+    #if !defined( PROTOCOL_USE_DESTINATION_FILTER )
     // Disable hardware filtering until a link is established.
     PhyDisableAddressFilter();
+    #endif
   }
   
   // Set remote address to broadcast address.
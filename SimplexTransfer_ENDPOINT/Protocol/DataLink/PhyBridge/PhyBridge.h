@@ -13,7 +13,7 @@
  *  Provides the interface for the protocol and the implementation from the
  *  physical hardware.
  *
- *  @version  1.0.01
+ *  @version  1.0.02
  *  @date     2 Jul 2012
  *  @author   BPB, air@anaren.com
  *
@@ -33,6 +33,19 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.02 : 19 Oct 2026
+ *  - added PhyGetAirtime
+ *  - added PhyScanChannels
+ *  - PhyConfigure keeps the channel, address filter and output power
+ *  - PhySetOutputPower takes the output power in dBm; added PhyGetOutputPower
+ *  - added PhyListen (End Point with PROTOCOL_USE_CSMA)
+ *  - added PhyGetDutyCycle
+ *  - data streams larger than the FIFO are streamed through the FIFO threshold
+ *  (PHY_USE_FIFO_STREAMING)
+ *  - PhyReceiverOn reads the data stream in place around the data field buffer
+ *  - added PhyFilterInit
+ *  - the physical timer may be held running past PhyTimerStop to complete a
+ *  radio state transition (sPhyTimer.held)
  *  ver 1.0.01 : 16 Oct 2012
  *  - updated internal documentation; comments revised
  *  ver 1.0.00 : 2 Jul 2012
@@ -67,8 +80,21 @@
 #define PROTOCOL_CRITICAL_SECTION(code)   MCU_CRITICAL_SECTION(code)
 
 // Maximum data stream size
-// Note: Currently set to the maximum physical hardware TX FIFO size.
+// Note: Set to the maximum physical hardware TX FIFO size unless the FIFOs are
+// refilled and drained during the transfer (PHY_USE_FIFO_STREAMING). A streamed
+// data stream is limited by its length field.
+#if defined( PHY_USE_FIFO_STREAMING )
+#ifndef PHY_MAX_DATASTREAM_SIZE
+#define PHY_MAX_DATASTREAM_SIZE           255
+#endif
+#define PROTOCOL_DATASTREAM_MAX_SIZE      PHY_MAX_DATASTREAM_SIZE
+#else
 #define PROTOCOL_DATASTREAM_MAX_SIZE      PHY_MAX_TXFIFO_SIZE
+#endif
+
+#if defined( PHY_USE_FIFO_STREAMING ) && (PHY_MAX_DATASTREAM_SIZE > 255)
+#error "PhyBridge Error: PHY_MAX_DATASTREAM_SIZE must fit the length field (255 bytes max)."
+#endif
 
 // Data stream overhead
 #define PROTOCOL_DATASTREAM_HEADER_LENGTH 1
@@ -76,6 +102,9 @@
 #define PROTOCOL_DATASTREAM_OVERHEAD      PROTOCOL_DATASTREAM_HEADER_LENGTH + PROTOCOL_DATASTREAM_FOOTER_LENGTH
 #define PROTOCOL_DATASTREAM_FOOTER_CRC    (0x0080u)
 #define PROTOCOL_DATASTREAM_FOOTER_LQI    (0x007Fu)
+
+// Duty cycle of a configuration without duty cycle requirement (0.1% steps)
+#define PHY_DUTY_CYCLE_UNRESTRICTED       1000
    
 /**
  *  tPower - absolute power (dBm) representation.
@@ -101,6 +130,9 @@ struct sPhyDevice
   struct sPhyDeviceStatus
   {
     volatile bool transmitting;       // Device transmitting flag
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+    bool listening;                   // Receiver on for the next clear channel assessment
+    #endif
     
     /**
      *  DataStreamSent - 
@@ -119,6 +151,18 @@ struct sPhyDevice
      */
     unsigned char(*DataStreamAvailable)(unsigned char *dataField, 
                                         unsigned char length);
+    
+    unsigned char filterLength;       // Data field bytes checked by the filter
+    
+    /**
+     *  DataStreamFilter - 
+     *
+     *    @param  dataField
+     *    @param  length
+     *
+     *    @return
+     */
+    bool(*DataStreamFilter)(unsigned char *dataField, unsigned char length);
   } status;
   
   /**
@@ -127,6 +171,7 @@ struct sPhyDevice
   struct sPhyTimer
   {
     bool running;                         // Hardware timer running flag
+    bool held;                            // Running only for a radio state transition
     
     /**
      *  Generic - 
@@ -186,6 +231,9 @@ struct sPhyDevice
       unsigned char length;       // Length of the data stream
     } header;
     unsigned char *dataField;     // Address + data field (payload)
+    #if defined( PHY_USE_FIFO_STREAMING )
+    unsigned int offset;          // Bytes moved through the FIFO (length included)
+    #endif
     /**
      *  sPhyDataStreamFooter - 
      */
@@ -242,7 +290,8 @@ void PhyDisable(void);
 // Physical configuration
 
 /**
- *  PhyConfigure - configure the physical hardware.
+ *  PhyConfigure - configure the physical hardware. The channel, the address 
+ *  filter and the output power are kept.
  *
  *  Note: The implementation of this function should automatically handle 
  *  transitioning Physical hardware from a low power state to an active state
@@ -252,7 +301,8 @@ void PhyDisable(void);
  *
  *    @return Success of physical hardware configuration. Please refer to the
  *            associated hardware driver for more information on potential
- *            failure conditions.
+ *            failure conditions (e.g. the channel is not approved for the
+ *            configuration).
  */
 bool PhyConfigure(unsigned char config);
 
@@ -295,7 +345,9 @@ bool PhySetChannel(unsigned char channel);
  *  transitioning Physical hardware from a low power state to an active state
  *  before performing the operation.
  *
- *    @param  power Index of the power level desired from a lookup table.
+ *    @param  power Output power desired (dBm). The lowest power level of the
+ *                  lookup table reaching this power is used, or the highest 
+ *                  power level when none does.
  */
 void PhySetOutputPower(tPower power);
 
@@ -304,7 +356,8 @@ void PhySetOutputPower(tPower power);
 
 /**
  *  PhyGetInstantSignalStrength - get instantaneous signal strength from the
- *  surrounding environment.
+ *  surrounding environment on the current channel. The receiver is turned on,
+ *  several samples are averaged and the hardware is left in an idle state.
  *
  *  Note: The implementation of this function should automatically handle 
  *  transitioning Physical hardware from a low power state to an active state
@@ -314,6 +367,29 @@ void PhySetOutputPower(tPower power);
  */
 tPower PhyGetInstantSignalStrength(void);
 
+/**
+ *  PhyScanChannels - measure the signal strength on every channel approved for
+ *  the current configuration and rank the quietest channels. The current 
+ *  channel is restored and the hardware is left in an idle state.
+ *
+ *    @param  channel Ranked channels, quietest first.
+ *    @param  power   Signal strength measured on each ranked channel.
+ *    @param  count   Number of entries available in channel and power.
+ *
+ *    @return Number of ranked channels (at most count).
+ */
+unsigned char PhyScanChannels(unsigned char *channel, 
+                              tPower *power, 
+                              unsigned char count);
+
+/**
+ *  PhyGetOutputPower - get the transmitter's output power selected with 
+ *  PhySetOutputPower, limited to the maximum power of the configuration.
+ *
+ *    @return Output power (dBm).
+ */
+tPower PhyGetOutputPower(void);
+
 /**
  *  PhyGetDataStreamStatus - retrieve the last received data stream's status
  *  information located in the data stream footer. This information includes
@@ -323,6 +399,26 @@ tPower PhyGetInstantSignalStrength(void);
  */
 struct sPhyDataStreamFooter* PhyGetDataStreamStatus(void);
 
+/**
+ *  PhyGetAirtime - get the time required to transmit a data stream with the
+ *  current configuration, including the preamble, sync word, data stream
+ *  header and CRC.
+ *
+ *    @param  length  Number of bytes in the data field.
+ *
+ *    @return Air time in timer ticks (milliseconds), rounded up.
+ */
+tTime PhyGetAirtime(unsigned char length);
+
+/**
+ *  PhyGetDutyCycle - get the maximum duty cycle allowed for the current
+ *  configuration.
+ *
+ *    @return Duty cycle in 0.1% steps (PHY_DUTY_CYCLE_UNRESTRICTED if the
+ *            configuration has no duty cycle requirement).
+ */
+unsigned int PhyGetDutyCycle(void);
+
 // -----------------------------------------------------------------------------
 // Physical operation
 
@@ -353,10 +449,25 @@ void PhyCalibrate(void);
  *
  *    @param  dataField   Buffer to store the received data field. This buffer 
  *                        is assumed to be large enough to store the largest
- *                        expected data field.
+ *                        expected data field (PROTOCOL_DATASTREAM_MAX_SIZE with
+ *                        PHY_USE_FIFO_STREAMING). The data stream is read in
+ *                        place: PROTOCOL_DATASTREAM_HEADER_LENGTH bytes before
+ *                        the buffer and PROTOCOL_DATASTREAM_FOOTER_LENGTH bytes
+ *                        after the largest data field are overwritten as well.
  */
 void PhyReceiverOn(unsigned char *dataField);
 
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+/**
+ *  PhyListen - turn on the Physical receiver ahead of the clear channel
+ *  assessment of the next PhyTransmit. The call returns immediately; the
+ *  receiver settles while the caller waits (at least one millisecond timer
+ *  tick) before calling PhyTransmit. PhyListen must always be followed by
+ *  PhyTransmit.
+ */
+void PhyListen(void);
+#endif
+
 /**
  *  PhyTransmit -  Build a data stream from the data field provided and transmit 
  *  the resulting data stream using the Physical hardware.
@@ -367,11 +478,16 @@ void PhyReceiverOn(unsigned char *dataField);
  *
  *    @param  dataField   Buffer that stores the data field to be encapsulated
  *                        into a data stream.
- *    @param  count       Number of bytes in the data field buffer.
+ *    @param  count       Number of bytes in the data field buffer (at most
+ *                        PROTOCOL_DATASTREAM_MAX_SIZE).
  *
  *    @return Success of the operation. If a device is already performing a
  *            transmission, this operation will fail until the initial transmit
- *            completes.
+ *            completes. When PROTOCOL_USE_CSMA is defined (End Point), the
+ *            operation also fails if the channel is not clear; the radio is
+ *            left idle in that case. The channel is only assessed if the
+ *            receiver was turned on by PhyListen; a data stream sent in a
+ *            reserved (TDMA) slot is transmitted without an assessment.
  */
 bool PhyTransmit(unsigned char *dataField, 
                  unsigned char count);
@@ -405,6 +521,9 @@ void PhyTimerStart(void);
 
 /**
  *  PhyTimerStop - stop the physical timer.
+ *
+ *  Note: The hardware timer keeps running without servicing the generic timer
+ *  while a radio state transition is pending; it stops once it completes.
  */
 void PhyTimerStop(void);
 
@@ -416,6 +535,27 @@ void PhyTimerStop(void);
  */
 void PhySyncTimerInit(unsigned char(*SyncTimeout)(void));
 
+/**
+ *  PhyFilterInit - register a filter run on the start of each received data
+ *  stream. Once the length field and the first filterLength bytes of the data 
+ *  field are read, the filter decides if the data stream is wanted. A rejected
+ *  data stream is flushed from the RX FIFO instead of being read and is 
+ *  reported to DataStreamAvailable with a length of zero.
+ *
+ *  Note: The filter is called from the Physical interrupt service routine, 
+ *  before the CRC is checked. It should not replace the checks done once the
+ *  whole data stream is available. It must reject a length field larger than
+ *  the receive buffer (see PhyReceiverOn); the rest of the data stream is read
+ *  in a single burst.
+ *  
+ *    @param  filterLength      Number of data field bytes needed by the filter.
+ *    @param  DataStreamFilter  Callback returning true if the data stream must
+ *                              be read, NULL to read every data stream.
+ */
+void PhyFilterInit(unsigned char filterLength,
+                   bool(*DataStreamFilter)(unsigned char *dataField, 
+                                           unsigned char length));
+
 // -----------------------------------------------------------------------------
 // Physical interrupt service routines
 
@@ -430,6 +570,10 @@ void PhySyncTimerInit(unsigned char(*SyncTimeout)(void));
  *  On transmission and EOP interrupt is set, a DataStreamSent callback is 
  *  invoked.
  *
+ *  With PHY_USE_FIFO_STREAMING, the FIFO threshold event also refills the TX
+ *  FIFO during a transmission and drains the RX FIFO during a reception. The
+ *  event of the FIFO threshold pin must then be passed as well.
+ *
  *    @param  event   SYNC/EOP event indicator. This is usually in the form of
  *                    a hardware peripheral flag indicating that the associated
  *                    hardware has been interrupted.
@@ -9,8 +9,8 @@
  *
  *  CC1101.c - CC110x/2500 device driver.
  *
- *  @version    1.0.13
- *  @date       15 Jan 2013
+ *  @version    1.0.14
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  For details on the interface, please see CC1101.h.
@@ -27,6 +27,20 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.14 : 19 Oct 2026
+ *  - added the configuration register shadow (CC1101_REGISTER_SHADOW); reads
+ *  of configuration registers are served from RAM and unchanged single 
+ *  register writes are skipped
+ *  - CC1101Configure only writes the registers that differ from the shadow
+ *  - added CC1101LoadShadow and CC1101Reconfigure
+ *  - added the asynchronous state transitions (CC1101SetStateAsync, 
+ *  CC1101CalibrateAsync, CC1101StateEvent)
+ *  - the SPI and GDOx calls may be bound to the platform at compile time 
+ *  (CC1101_STATIC_HAL)
+ *  - added CC1101ReportError for errors detected by the platform (a dropped SPI
+ *  transaction)
+ *  - added a host test stub counting the SPI traffic against a simulated chip
+ *  (TEST_CC1101_SPI)
  *  ver 1.0.13 : 15 Jan 2013
  *	- fixed an issue with the sleep flag so that it may be cleared prior to
  *	attempting to write the unretained registers in the wake up routine.
@@ -95,6 +109,22 @@
  *  Defines, enumerations, and structure definitions
  */
 
+// SPI access through the platform functions (CC1101_STATIC_HAL) or through the
+// SPI interface pointers.
+#ifdef CC1101_STATIC_HAL
+#define CC1101_SPI_INIT(phyInfo)  CC1101_CONCAT(CC1101_STATIC_HAL, SpiInit)()
+#define CC1101_SPI_READ(phyInfo, address, buffer, count)\
+  CC1101_CONCAT(CC1101_STATIC_HAL, SpiRead)(address, buffer, count)
+#define CC1101_SPI_WRITE(phyInfo, address, buffer, count)\
+  CC1101_CONCAT(CC1101_STATIC_HAL, SpiWrite)(address, buffer, count)
+#else
+#define CC1101_SPI_INIT(phyInfo)  (phyInfo)->spi->Init()
+#define CC1101_SPI_READ(phyInfo, address, buffer, count)\
+  (phyInfo)->spi->Read(address, buffer, count)
+#define CC1101_SPI_WRITE(phyInfo, address, buffer, count)\
+  (phyInfo)->spi->Write(address, buffer, count)
+#endif
+
 // -----------------------------------------------------------------------------
 /**
  *  Global data
@@ -114,6 +144,61 @@ static void(*CC1101ErrorHandler)(enum eCC1101Error) = NULL;
  *  Private interface
  */
 
+#ifdef CC1101_REGISTER_SHADOW
+/**
+ *  CC1101ShadowHit - check if a range of registers can be served from the
+ *  configuration register shadow. The frequency synthesizer calibration 
+ *  registers (FSCAL3 to FSCAL0) are updated by the chip and are never served
+ *  from the shadow.
+ *
+ *    @param  phyInfo CC1101 interface state information used by the interface
+ *                    for all chip interaction.
+ *    @param  address The first register address of the range.
+ *    @param  count   Number of registers in the range.
+ *
+ *    @return True if every register of the range is held by the shadow.
+ */
+bool CC1101ShadowHit(struct sCC1101PhyInfo *phyInfo, 
+                     unsigned char address,
+                     unsigned char count)
+{
+  unsigned int end = (unsigned int)address + count;
+  
+  if (!phyInfo->shadowValid || count == 0)
+  {
+    return false;
+  }
+  
+  return end <= CC1101_REG_FSCAL3
+         || (address > CC1101_REG_FSCAL0 && end <= CC1101_SHADOW_SIZE);
+}
+#endif
+
+#ifdef CC1101_REGISTER_SHADOW
+/**
+ *  CC1101ShadowUpdate - store the configuration registers of a write in the 
+ *  shadow. Registers outside of the configuration register space (PA table, 
+ *  FIFOs, and strobes) are ignored.
+ *
+ *    @param  phyInfo CC1101 interface state information used by the interface
+ *                    for all chip interaction.
+ *    @param  address The radio register address written to.
+ *    @param  buffer  Values written to the CC1101.
+ *    @param  count   Number of registers written.
+ */
+void CC1101ShadowUpdate(struct sCC1101PhyInfo *phyInfo, 
+                        unsigned char address, 
+                        const unsigned char *buffer, 
+                        unsigned char count)
+{
+  while (count > 0 && address < CC1101_SHADOW_SIZE)
+  {
+    phyInfo->shadow[address++] = *buffer++;
+    count--;
+  }
+}
+#endif
+
 /**
  *  CC1101Read - read from the internal radio registers. Values returned from 
  *  the CC1101x/2500 device are written into the provided buffer based on
@@ -160,7 +245,7 @@ void CC1101Read(struct sCC1101PhyInfo *phyInfo,
       }
     }
   
-    phyInfo->spi->Read(address, buffer, count);
+    CC1101_SPI_READ(phyInfo, address, buffer, count);
   }
   #ifdef CC1101_ERROR_HANDLING
   else
@@ -205,13 +290,18 @@ void CC1101Write(struct sCC1101PhyInfo *phyInfo,
 {
   if (!phyInfo->sleep)
   {
+    #ifdef CC1101_REGISTER_SHADOW
+    // The shadow is written through.
+    CC1101ShadowUpdate(phyInfo, address, buffer, count);
+    #endif
+    
     // Format command (R/W, Burst/Single, Address[5:0]).
     if (count > 1)
     {
       address = address | CC1101_WRITE_BURST;
     }
     
-    phyInfo->spi->Write(address, buffer, count);
+    CC1101_SPI_WRITE(phyInfo, address, buffer, count);
   }
   #ifdef CC1101_ERROR_HANDLING
   else
@@ -226,6 +316,58 @@ void CC1101Write(struct sCC1101PhyInfo *phyInfo,
   #endif
 }
 
+#ifdef CC1101_REGISTER_SHADOW
+/**
+ *  CC1101WriteChanged - write the runs of configuration registers that differ
+ *  from the shadow (e.g. the modem registers when switching between 
+ *  configurations). The shadow must be valid.
+ *
+ *    @param  phyInfo     CC1101 interface state information used by the 
+ *                        interface for all chip interaction.
+ *    @param  config      Radio configuration register settings.
+ *    @param  calibration Also write the frequency synthesizer calibration
+ *                        registers (FSCAL3 to FSCAL0). They are not held by
+ *                        the shadow, so they are either always written or
+ *                        never written.
+ */
+void CC1101WriteChanged(struct sCC1101PhyInfo *phyInfo, 
+                        const struct sCC1101 *config,
+                        bool calibration)
+{
+  const unsigned char *image = (const unsigned char*)config;
+  unsigned char address = 0;
+  unsigned char count;
+  
+  while (address < CC1101_SHADOW_SIZE)
+  {
+    if (!calibration && address == CC1101_REG_FSCAL3)
+    {
+      address = CC1101_REG_FSCAL0 + 1;
+      continue;
+    }
+    
+    count = 0;
+    while ((address + count) < CC1101_SHADOW_SIZE
+           && (calibration || (address + count) != CC1101_REG_FSCAL3)
+           && (!CC1101ShadowHit(phyInfo, address + count, 1)
+               || image[address + count] != phyInfo->shadow[address + count]))
+    {
+      count++;
+    }
+    
+    if (count > 0)
+    {
+      CC1101Write(phyInfo, address, &image[address], count);
+      address += count;
+    }
+    else
+    {
+      address++;
+    }
+  }
+}
+#endif
+
 /**
  *  CC1101GetChipPartnum - get the hardware part number.
  *
@@ -317,6 +459,9 @@ void CC1101DefaultErrorHandler(enum eCC1101Error error)
     case eCC1101ErrorSleep:
       msg = "CC1101 Error: sleep-wakeup sequence incorrect";
       break;
+    case eCC1101ErrorSpi:
+      msg = "CC1101 Error: SPI transaction dropped";
+      break;
     default:
       msg = "CC1101 Error: unknown";
       break;
@@ -333,6 +478,9 @@ void CC1101DefaultErrorHandler(enum eCC1101Error error)
     case eCC1101ErrorSleep:
       msg = eCC1101ErrorSleep;
       break;
+    case eCC1101ErrorSpi:
+      msg = eCC1101ErrorSpi;
+      break;
     default:
       break;
   }
@@ -413,6 +561,10 @@ void CC1101SpiInit(struct sCC1101PhyInfo *phyInfo,
                    void(*const ErrorHandler)(enum eCC1101Error))
 {
   phyInfo->sleep = false;
+  phyInfo->transition.Complete = NULL;
+  #ifdef CC1101_REGISTER_SHADOW
+  phyInfo->shadowValid = false;
+  #endif
   
   // Attach error handler to be used by this device driver.
   #ifdef CC1101_ERROR_HANDLING
@@ -429,9 +581,19 @@ void CC1101SpiInit(struct sCC1101PhyInfo *phyInfo,
   phyInfo->spi = (struct sCC1101Spi*)spi;
   
   // Setup required Serial Peripheral Interface (SPI).
-  phyInfo->spi->Init();
+  CC1101_SPI_INIT(phyInfo);
 }
 
+#ifdef CC1101_ERROR_HANDLING
+void CC1101ReportError(enum eCC1101Error error)
+{
+  if (CC1101ErrorHandler != NULL)
+  {
+    CC1101ErrorHandler(error);
+  }
+}
+#endif
+
 void CC1101GdoInit(struct sCC1101PhyInfo *phyInfo, 
                    const struct sCC1101Gdo *gdo[3])
 {
@@ -474,14 +636,56 @@ bool CC1101Configure(struct sCC1101PhyInfo *phyInfo, const struct sCC1101 *confi
     return false;
   }
   
+  #ifdef CC1101_REGISTER_SHADOW
+  if (phyInfo->shadowValid)
+  {
+    // The frequency synthesizer calibration registers are written as well.
+    CC1101WriteChanged(phyInfo, config, true);
+    return true;
+  }
+  #endif
+  
   CC1101Write(phyInfo,
               0x00, 
               (unsigned char *)((struct sCC1101*)config), 
               sizeof(struct sCC1101)/sizeof(unsigned char));
   
+  #ifdef CC1101_REGISTER_SHADOW
+  // The whole register file has been written through the shadow.
+  phyInfo->shadowValid = !phyInfo->sleep;
+  #endif
+  
   return true;
 }
 
+#ifdef CC1101_REGISTER_SHADOW
+bool CC1101LoadShadow(struct sCC1101PhyInfo *phyInfo)
+{
+  if (!CC1101SetAndVerifyState(phyInfo, CC1101_SIDLE, eCC1101MarcStateIdle))
+  {
+    return false;
+  }
+  
+  CC1101Read(phyInfo, 0x00, phyInfo->shadow, CC1101_SHADOW_SIZE);
+  phyInfo->shadowValid = !phyInfo->sleep;
+  
+  return phyInfo->shadowValid;
+}
+
+bool CC1101Reconfigure(struct sCC1101PhyInfo *phyInfo, const struct sCC1101 *config)
+{
+  if (!phyInfo->shadowValid
+      || !CC1101SetAndVerifyState(phyInfo, CC1101_SIDLE, eCC1101MarcStateIdle))
+  {
+    return false;
+  }
+  
+  CC1101WriteChanged(phyInfo, config, false);
+  
+  return true;
+}
+#endif
+
 unsigned char CC1101GetRegister(struct sCC1101PhyInfo *phyInfo,
                                 unsigned char address)
 {
@@ -504,6 +708,12 @@ unsigned char CC1101GetRegister(struct sCC1101PhyInfo *phyInfo,
     default:
       {
         unsigned char value;
+        #ifdef CC1101_REGISTER_SHADOW
+        if (CC1101ShadowHit(phyInfo, address, 1))
+        {
+          return phyInfo->shadow[address];
+        }
+        #endif
         CC1101Read(phyInfo, address, &value, 1);
         return value;
       }
@@ -514,6 +724,14 @@ void CC1101SetRegister(struct sCC1101PhyInfo *phyInfo,
                        unsigned char address, 
                        unsigned char value)
 {
+  #ifdef CC1101_REGISTER_SHADOW
+  // Skip the write if the register already holds the value.
+  if (CC1101ShadowHit(phyInfo, address, 1) && phyInfo->shadow[address] == value)
+  {
+    return;
+  }
+  #endif
+  
   CC1101Write(phyInfo, address, &value, 1);
 }
 
@@ -528,6 +746,19 @@ void CC1101ReadRegisters(struct sCC1101PhyInfo *phyInfo,
   }
   else if (count > 1)
   {
+    #ifdef CC1101_REGISTER_SHADOW
+    if (CC1101ShadowHit(phyInfo, address, count))
+    {
+      unsigned char i;
+      
+      for (i = 0; i < count; i++)
+      {
+        buffer[i] = phyInfo->shadow[address + i];
+      }
+      return;
+    }
+    #endif
+    
     CC1101Read(phyInfo, address, buffer, count);
   }
 }
@@ -586,6 +817,14 @@ void CC1101WriteTxFifo(struct sCC1101PhyInfo *phyInfo,
 
 void CC1101Strobe(struct sCC1101PhyInfo *phyInfo, unsigned char command)
 {
+  #ifdef CC1101_REGISTER_SHADOW
+  // A chip reset restores the default register values.
+  if (command == CC1101_SRES)
+  {
+    phyInfo->shadowValid = false;
+  }
+  #endif
+  
   CC1101Write(phyInfo, (command & 0xBF), NULL, 0);
 }
 
@@ -616,6 +855,65 @@ bool CC1101Calibrate(struct sCC1101PhyInfo *phyInfo)
   return true;
 }
 
+bool CC1101CalibrateAsync(struct sCC1101PhyInfo *phyInfo,
+                          unsigned int timeout,
+                          unsigned char(*Complete)(bool success))
+{
+  // A calibration strobe is only accepted in the IDLE state.
+  if (CC1101StatePending(phyInfo) 
+      || CC1101GetMarcState(phyInfo) != eCC1101MarcStateIdle)
+  {
+    return false;
+  }
+  
+  CC1101SetStateAsync(phyInfo, CC1101_SCAL, eCC1101MarcStateIdle, timeout, Complete);
+  
+  return true;
+}
+
+void CC1101SetStateAsync(struct sCC1101PhyInfo *phyInfo,
+                         unsigned char command,
+                         enum eCC1101MarcState state,
+                         unsigned int timeout,
+                         unsigned char(*Complete)(bool success))
+{
+  phyInfo->transition.state = state;
+  phyInfo->transition.timeout = timeout;
+  phyInfo->transition.Complete = Complete;
+  
+  CC1101Strobe(phyInfo, command);
+}
+
+unsigned char CC1101StateEvent(struct sCC1101PhyInfo *phyInfo)
+{
+  unsigned char(*Complete)(bool) = phyInfo->transition.Complete;
+  bool success;
+  
+  if (Complete == NULL)
+  {
+    return 0;
+  }
+  
+  success = (CC1101GetMarcState(phyInfo) == phyInfo->transition.state);
+  if (!success && phyInfo->transition.timeout > 1)
+  {
+    phyInfo->transition.timeout--;
+    return 0;
+  }
+  
+  #ifdef CC1101_ERROR_HANDLING
+  if (!success)
+  {
+    CC1101ErrorHandler(eCC1101ErrorTimeout);
+  }
+  #endif
+  
+  // The transition is complete; the callback may start another one.
+  phyInfo->transition.Complete = NULL;
+  
+  return Complete(success);
+}
+
 bool CC1101Sleep(struct sCC1101PhyInfo *phyInfo)
 {
   if (!phyInfo->sleep)
@@ -697,6 +995,10 @@ void CC1101Wakeup(struct sCC1101PhyInfo *phyInfo,
  */
 #ifdef TEST_CC1101
 
+#ifdef CC1101_STATIC_HAL
+#error "CC1101 Error: the test stub uses the SPI/GDOx interface pointers. Undefine CC1101_STATIC_HAL."
+#endif
+
 /**
  *  Test Example - test the functionality of the CC110x/2500 device driver.
  *
@@ -1076,3 +1378,226 @@ __interrupt void Port2Isr()
 #endif
 
 #endif  /* TEST_CC1101 */
+
+/**
+ *  To count the SPI traffic of the driver, define the following in your 
+ *  compiler preprocessor definitions: "TEST_CC1101_SPI". The stub runs on the 
+ *  host against a simulated chip; build this file alone, e.g.
+ *
+ *    gcc -DTEST_CC1101_SPI -DCC1101_REGISTER_SHADOW CC1101.c
+ */
+#ifdef TEST_CC1101_SPI
+
+#ifdef CC1101_STATIC_HAL
+#error "CC1101 Error: the test stub uses the SPI/GDOx interface pointers. Undefine CC1101_STATIC_HAL."
+#endif
+
+#ifndef CC1101_REGISTER_SHADOW
+#error "CC1101 Error: TEST_CC1101_SPI requires CC1101_REGISTER_SHADOW."
+#endif
+
+/**
+ *  Test Example - count the SPI transactions and bytes of the configuration and
+ *  the warm start reconfiguration, and check the registers left on the chip.
+ *  The RX FIFO drain is tested with PhyGetDataStream (TEST_PHY_BRIDGE_RX).
+ *
+ *  @version    1.0.01
+ *  @date       19 Oct 2026
+ *  @platform   Host PC
+ *  @compiler   Any ANSI C compiler
+ *
+ *  assumptions
+ *  ===========
+ *  - a byte on the bus is counted for the address/command byte and for each 
+ *  data byte of a transaction
+ *  - the simulated chip returns the same status register value on every read,
+ *  so the SPI read synchronization workaround reads a register twice
+ *  - the simulated chip enters IDLE on SIDLE; the calibration is simulated by 
+ *  changing FSCAL3 to FSCAL0 directly
+ *
+ *  file dependency
+ *  ===============
+ *  stdio.h : used to report the results
+ *  string.h : memcpy, memcmp
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.01 : 19 Oct 2026
+ *  - the RX FIFO drain moved to the physical bridge test stub
+ *  (TEST_PHY_BRIDGE_RX) so that PhyGetDataStream itself is tested
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include <stdio.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+
+struct sTestCount
+{
+  unsigned int readTransactions;
+  unsigned int readBytes;
+  unsigned int writeTransactions;
+  unsigned int writeBytes;
+};
+
+// Simulated chip.
+static unsigned char gChipRegisters[CC1101_SHADOW_SIZE];
+static enum eCC1101MarcState gChipState = eCC1101MarcStateIdle;
+
+static struct sTestCount gCount;
+static unsigned int gFailures = 0;
+
+// -----------------------------------------------------------------------------
+
+void TestSpiInit()
+{
+}
+
+void TestSpiRead(unsigned char address, unsigned char *buffer, unsigned char count)
+{
+  unsigned char reg = address & 0x3F;
+  unsigned char i;
+  
+  gCount.readTransactions++;
+  gCount.readBytes += 1 + count;
+  
+  for (i = 0; i < count; i++)
+  {
+    if (reg == CC1101_MARCSTATE)
+    {
+      buffer[i] = (unsigned char)gChipState;
+    }
+    else if (reg + i < CC1101_SHADOW_SIZE)
+    {
+      buffer[i] = gChipRegisters[reg + i];
+    }
+    else
+    {
+      buffer[i] = 0;
+    }
+  }
+}
+
+void TestSpiWrite(unsigned char address, const unsigned char *buffer, unsigned char count)
+{
+  unsigned char reg = address & 0x3F;
+  unsigned char i;
+  
+  gCount.writeTransactions++;
+  gCount.writeBytes += 1 + count;
+  
+  // Command strobes have no data bytes.
+  if (count == 0)
+  {
+    if (reg == CC1101_SIDLE)
+    {
+      gChipState = eCC1101MarcStateIdle;
+    }
+    return;
+  }
+  
+  for (i = 0; i < count && reg + i < CC1101_SHADOW_SIZE; i++)
+  {
+    gChipRegisters[reg + i] = buffer[i];
+  }
+}
+
+static struct sCC1101Spi gTestSpi = { TestSpiInit, TestSpiRead, TestSpiWrite };
+static struct sCC1101PhyInfo gTestPhyInfo;
+
+// Base profile (same settings as the TEST_CC1101 stub).
+static const unsigned char gTestProfileA[CC1101_SHADOW_SIZE] = {
+  0x2E, 0x2E, 0x06, 0x07, 0xD3, 0x91, 0xFF, 0x0C,   // IOCFG2 - PKTCTRL1
+  0x05, 0x00, 0x00, 0x0A, 0x00, 0x22, 0xB6, 0x27,   // PKTCTRL0 - FREQ0
+  0x35, 0x83, 0x03, 0x21, 0xEE, 0x65, 0x07, 0x00,   // MDMCFG4 - MCSM1
+  0x18, 0x16, 0x6C, 0x07, 0x40, 0x91, 0x87, 0x6B,   // MCSM0 - WOREVT0
+  0xF8, 0x57, 0x10, 0xE9, 0x2A, 0x00, 0x1F, 0x41,   // WORCTRL - RCCTRL1
+  0x00, 0x59, 0x7F, 0x3C, 0x88, 0x35, 0x09          // RCCTRL0 - TEST0
+};
+
+// Another data rate on another channel: MDMCFG4/3, DEVIATN and CHANNR differ.
+static unsigned char gTestProfileB[CC1101_SHADOW_SIZE];
+
+// Calibration results left by the chip.
+static const unsigned char gTestCalibration[4] = { 0xEA, 0x2A, 0x00, 0x11 };
+
+// -----------------------------------------------------------------------------
+
+static void TestCountReset(void)
+{
+  memset(&gCount, 0, sizeof(gCount));
+}
+
+static void TestExpect(const char *name, unsigned int value, unsigned int expected)
+{
+  printf("  %-44s %4u (expected %u)\n", name, value, expected);
+  if (value != expected)
+  {
+    gFailures++;
+  }
+}
+
+/**
+ *  TestConfigure - configure the chip without and with a valid shadow. The 
+ *  IDLE verification reads MARCSTATE in both cases; the counts are the writes.
+ */
+static void TestConfigure(void)
+{
+  printf("CC1101Configure\n");
+  
+  TestCountReset();
+  CC1101Configure(&gTestPhyInfo, (const struct sCC1101*)gTestProfileA);
+  TestExpect("full image: SPI write transactions", gCount.writeTransactions, 2);
+  TestExpect("full image: SPI write bytes", gCount.writeBytes, 49);
+  
+  TestCountReset();
+  CC1101Configure(&gTestPhyInfo, (const struct sCC1101*)gTestProfileB);
+  TestExpect("delta from the shadow: SPI write transactions", gCount.writeTransactions, 5);
+  TestExpect("delta from the shadow: SPI write bytes", gCount.writeBytes, 13);
+  TestExpect("delta from the shadow: chip registers", 
+             memcmp(gChipRegisters, gTestProfileB, CC1101_SHADOW_SIZE) == 0, 1);
+}
+
+/**
+ *  TestWarmStart - reconfigure a calibrated chip as the A110LR09 warm start 
+ *  does. The calibration results must be kept.
+ */
+static void TestWarmStart(void)
+{
+  printf("CC1101Reconfigure (warm start)\n");
+  
+  memcpy(&gChipRegisters[CC1101_REG_FSCAL3], gTestCalibration, sizeof(gTestCalibration));
+  
+  TestCountReset();
+  CC1101Reconfigure(&gTestPhyInfo, (const struct sCC1101*)gTestProfileA);
+  TestExpect("SPI write transactions", gCount.writeTransactions, 4);
+  TestExpect("SPI write bytes", gCount.writeBytes, 8);
+  TestExpect("FSCAL3 to FSCAL0 kept", 
+             memcmp(&gChipRegisters[CC1101_REG_FSCAL3], gTestCalibration, 
+                    sizeof(gTestCalibration)) == 0, 1);
+  TestExpect("other registers configured", 
+             memcmp(gChipRegisters, gTestProfileA, CC1101_REG_FSCAL3) == 0
+             && memcmp(&gChipRegisters[CC1101_REG_FSCAL0 + 1], 
+                       &gTestProfileA[CC1101_REG_FSCAL0 + 1],
+                       CC1101_SHADOW_SIZE - (CC1101_REG_FSCAL0 + 1)) == 0, 1);
+}
+
+int main(void)
+{
+  memcpy(gTestProfileB, gTestProfileA, CC1101_SHADOW_SIZE);
+  gTestProfileB[CC1101_REG_CHANNR] = 0x05;
+  gTestProfileB[CC1101_REG_MDMCFG4] = 0xCA;
+  gTestProfileB[CC1101_REG_MDMCFG4 + 1] = 0x3B;         // MDMCFG3
+  gTestProfileB[CC1101_REG_DEVIATN] = 0x35;
+  
+  CC1101SpiInit(&gTestPhyInfo, &gTestSpi, NULL);
+  
+  TestConfigure();
+  TestWarmStart();
+  
+  printf("%u failure(s)\n", gFailures);
+  return gFailures != 0;
+}
+
+#endif  /* TEST_CC1101_SPI */
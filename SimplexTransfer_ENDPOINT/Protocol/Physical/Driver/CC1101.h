@@ -11,8 +11,8 @@
  *
  *  CC1101.h - CC110x/2500 device driver.
  *
- *  @version    1.0.12
- *  @date       27 Sep 2012
+ *  @version    1.0.14
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  The CC1101/110L is a transceiver intended for use in the Industrial, 
@@ -105,7 +105,8 @@
  *
  *  When device driver debugging is not needed, define "NDEBUG" in your 
  *  compiler's preprocessor options. Error handling can be turned on by defining
- *  "CC1101_ERROR_HANDLING".
+ *  "CC1101_ERROR_HANDLING". A RAM shadow of the configuration registers can be
+ *  turned on by defining "CC1101_REGISTER_SHADOW" (see sCC1101PhyInfo).
  *
  *  The following documents were used during the development of this device
  *  driver:
@@ -139,6 +140,19 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.14 : 19 Oct 2026
+ *  - added the configuration register shadow (CC1101_REGISTER_SHADOW)
+ *  - CC1101Configure only writes the registers that differ from the shadow
+ *  - added CC1101LoadShadow and CC1101Reconfigure
+ *  - added the asynchronous state transitions (CC1101SetStateAsync, 
+ *  CC1101CalibrateAsync, CC1101StateEvent)
+ *  - the SPI and GDOx calls may be bound to the platform at compile time 
+ *  (CC1101_STATIC_HAL)
+ *  - added CC1101ReportError and eCC1101ErrorSpi for SPI transactions dropped
+ *  by the platform
+ *  ver 1.0.13 : 19 Oct 2026
+ *  - exposed CC1101GetRegisterWithSpiSyncProblem and added 
+ *  CC1101GetRssiWithSpiSyncProblem for RSSI reads while the receiver is active
  *	ver 1.0.12 : 27 Sep 2012
  *	- split CC1101Init into CC1101SpiInit and CC1101GdoInit. The GDO interface
  *	may not be desired in some circumstances (e.g. test).
@@ -550,6 +564,9 @@
 // Maximum timeout error ticks
 #define CC1101_MAX_TIMEOUT        2000
 
+// Configuration registers held by the register shadow (IOCFG2 to TEST0)
+#define CC1101_SHADOW_SIZE        (CC1101_REG_TEST0 + 1)
+
 // -----------------------------------------------------------------------------
 
 /**
@@ -558,7 +575,8 @@
 enum eCC1101Error
 {
   eCC1101ErrorTimeout     = 0x01u,
-  eCC1101ErrorSleep       = 0x02u
+  eCC1101ErrorSleep       = 0x02u,
+  eCC1101ErrorSpi         = 0x03u     // SPI transaction dropped by the platform
 };
 
 /**
@@ -722,12 +740,35 @@ struct sCC1101Gdo
  *  Note: It is assumed that this structure is defined in static memory. This is
  *  because the CC1101 interface depends on the integrity of the data stored for
  *  all its operations.
+ *
+ *  Note: With CC1101_REGISTER_SHADOW, every configuration register write is 
+ *  also stored in the shadow. Once CC1101Configure has written the whole 
+ *  register file, configuration register reads are served from the shadow and
+ *  single register writes of an unchanged value are skipped. The shadow is
+ *  invalidated by a chip reset (SRES). The frequency synthesizer calibration
+ *  registers (FSCAL3 to FSCAL0) are updated by the chip and always go over SPI,
+ *  as do the status registers and the FIFOs.
  */
 struct sCC1101PhyInfo
 {
   struct sCC1101Spi *spi;     // Interface for SPI
   struct sCC1101Gdo *gdo[3];  // Interface for GDOx
   volatile bool sleep;        // Chip sleep flag
+  
+  /**
+   *  sCC1101Transition - pending asynchronous state transition (see 
+   *  CC1101SetStateAsync).
+   */
+  struct sCC1101Transition
+  {
+    enum eCC1101MarcState state;                  // State waited for
+    unsigned int timeout;                         // Events left before timeout
+    unsigned char(*volatile Complete)(bool);      // Callback, NULL when idle
+  } transition;
+  #ifdef CC1101_REGISTER_SHADOW
+  bool shadowValid;                         // Shadow matches the chip
+  unsigned char shadow[CC1101_SHADOW_SIZE]; // Configuration register shadow
+  #endif
 };
 
 // -----------------------------------------------------------------------------
@@ -780,6 +821,17 @@ void CC1101SpiInit(struct sCC1101PhyInfo *phyInfo,
                    const struct sCC1101Spi *spi,
                    void(*const ErrorHandler)(enum eCC1101Error));
 
+#ifdef CC1101_ERROR_HANDLING
+/**
+ *  CC1101ReportError - pass an error detected outside of the device driver 
+ *  (e.g. a SPI transaction dropped by the platform) to the error handler given 
+ *  to CC1101SpiInit.
+ *
+ *    @param  error   Error code for the error that occurred.
+ */
+void CC1101ReportError(enum eCC1101Error error);
+#endif
+
 /**
  *  CC1101GdoInit - initialize the General Digital Output (GDOx) interface 
  *  (GDO0, GDO1, GDO2).
@@ -801,6 +853,10 @@ void CC1101GdoInit(struct sCC1101PhyInfo *phyInfo,
  *  CC1101Configure - set all hardware configuration registers excluding the PA
  *  table.
  *
+ *  Note: With CC1101_REGISTER_SHADOW, once the register file is known only the
+ *  runs of registers that differ from the shadow are written (plus FSCAL3 to
+ *  FSCAL0). Otherwise the whole register file is written in a single burst.
+ *
  *    @param  phyInfo CC1101 interface state information used by the interface
  *                    for all chip interaction.
  *    @param  pConfig Radio configuration register settings.
@@ -809,6 +865,34 @@ void CC1101GdoInit(struct sCC1101PhyInfo *phyInfo,
  */
 bool CC1101Configure(struct sCC1101PhyInfo *phyInfo, const struct sCC1101 *config);
 
+#ifdef CC1101_REGISTER_SHADOW
+/**
+ *  CC1101LoadShadow - strobe the CC1101 to an IDLE state and read the live 
+ *  configuration registers into the shadow. This allows the configuration left
+ *  in the chip (e.g. across a processor reset) to be inspected and reused 
+ *  without a chip reset.
+ *
+ *    @param  phyInfo CC1101 interface state information used by the interface
+ *                    for all chip interaction.
+ *
+ *    @return Success of the operation.
+ */
+bool CC1101LoadShadow(struct sCC1101PhyInfo *phyInfo);
+
+/**
+ *  CC1101Reconfigure - write the configuration registers that differ from the
+ *  shadow, keeping the frequency synthesizer calibration (FSCAL3 to FSCAL0) of
+ *  the chip. This is used to reuse a configuration read by CC1101LoadShadow.
+ *
+ *    @param  phyInfo CC1101 interface state information used by the interface
+ *                    for all chip interaction.
+ *    @param  config  Radio configuration register settings.
+ *
+ *    @return Success of the operation (false if the shadow is not valid).
+ */
+bool CC1101Reconfigure(struct sCC1101PhyInfo *phyInfo, const struct sCC1101 *config);
+#endif
+
 /**
  *  CC1101GetRegister - get a configuration register value. This is limited to
  *  registers that use single read access (no PA table as it requires burst read
@@ -827,6 +911,23 @@ bool CC1101Configure(struct sCC1101PhyInfo *phyInfo, const struct sCC1101 *confi
 unsigned char CC1101GetRegister(struct sCC1101PhyInfo *phyInfo,
                                 unsigned char address);
 
+/**
+ *  CC1101GetRegisterWithSpiSyncProblem - get a register value that is affected 
+ *  by the SPI synchronization issue described in the CC1101 Errata Notes. The
+ *  register is read until two consecutive reads match (up to four reads).
+ *
+ *  Note: CC1101GetRegister already uses this workaround for every affected
+ *  register except RSSI.
+ *
+ *    @param  phyInfo CC1101 interface state information used by the interface
+ *                    for all chip interaction.
+ *    @param  address Hardware register address to read value from.
+ *    
+ *    @return Valid value at the address specified.
+ */
+unsigned char CC1101GetRegisterWithSpiSyncProblem(struct sCC1101PhyInfo *phyInfo, 
+                                                  unsigned char address);
+
 /**
  *  CC1101SetRegister - set a configuration register value. This is limited to
  *  registers that use single write access (no PA table as it requires burst
@@ -984,6 +1085,20 @@ void CC1101WriteTxFifo(struct sCC1101PhyInfo *phyInfo,
 #define CC1101GetRssi(phyInfo)\
   CC1101GetRegister(phyInfo, CC1101_RSSI)
 
+/**
+ *  CC1101GetRssiWithSpiSyncProblem - get the receive signal strength indicator
+ *  (RSSI) value while the receiver is active. The read is protected against
+ *  the SPI synchronization issue (see CC1101GetRegisterWithSpiSyncProblem).
+ *
+ *    @param  struct sCC1101PhyInfo*  phyInfo CC1101 interface state information 
+ *                                            used by the interface for all chip 
+ *                                            interaction.
+ *  
+ *    @return unsigned char   Last RSSI sample value obtained.
+ */
+#define CC1101GetRssiWithSpiSyncProblem(phyInfo)\
+  CC1101GetRegisterWithSpiSyncProblem(phyInfo, CC1101_RSSI)
+
 /**
  *  CC1101GetLqi - get the link quality indicator (LQI) value for the last RX 
  *  state.
@@ -1093,6 +1208,70 @@ bool CC1101TurnOffCrystalOscillator(struct sCC1101PhyInfo *phyInfo);
  */
 bool CC1101Calibrate(struct sCC1101PhyInfo *phyInfo);
 
+/**
+ *  CC1101CalibrateAsync - start a manual calibration of the radio from the 
+ *  IDLE state without waiting for it. The callback is invoked by 
+ *  CC1101StateEvent once the radio is back in IDLE.
+ *
+ *    @param  phyInfo   CC1101 interface state information used by the 
+ *                      interface for all chip interaction.
+ *    @param  timeout   Number of events before the calibration times out.
+ *    @param  Complete  Callback invoked with the success of the calibration.
+ *
+ *    @return False if the radio is not in the IDLE state or a state transition
+ *            is already pending (nothing is started).
+ */
+bool CC1101CalibrateAsync(struct sCC1101PhyInfo *phyInfo,
+                          unsigned int timeout,
+                          unsigned char(*Complete)(bool success));
+
+/**
+ *  CC1101SetStateAsync - strobe the CC1101 to go to a certain state without 
+ *  waiting for it (see CC1101SetAndVerifyState). The state is checked once per
+ *  call of CC1101StateEvent, which the caller issues on a GDOx or timer event;
+ *  the processor may sleep in between instead of polling MARCSTATE over SPI.
+ *
+ *  Note: CC1101_SNOP may be used as the command to wait for a transition that
+ *  the radio performs on its own (e.g. TX_END to the TXOFF_MODE state).
+ *
+ *    @param  phyInfo   CC1101 interface state information used by the 
+ *                      interface for all chip interaction.
+ *    @param  command   Command strobe issued to the radio.
+ *    @param  state     State that completes the transition.
+ *    @param  timeout   Number of events before the transition times out.
+ *    @param  Complete  Callback invoked with the success of the transition. Its
+ *                      return value is returned by CC1101StateEvent.
+ */
+void CC1101SetStateAsync(struct sCC1101PhyInfo *phyInfo,
+                         unsigned char command,
+                         enum eCC1101MarcState state,
+                         unsigned int timeout,
+                         unsigned char(*Complete)(bool success));
+
+/**
+ *  CC1101StateEvent - check the pending asynchronous state transition. The 
+ *  radio state is read once. The callback is invoked once the state is reached
+ *  or the timeout expires.
+ *
+ *    @param  phyInfo CC1101 interface state information used by the interface
+ *                    for all chip interaction.
+ *
+ *    @return Status message from the callback, zero when no callback was 
+ *            invoked.
+ */
+unsigned char CC1101StateEvent(struct sCC1101PhyInfo *phyInfo);
+
+/**
+ *  CC1101StatePending - check if an asynchronous state transition is pending.
+ *
+ *    @param  struct sCC1101PhyInfo*  phyInfo CC1101 interface state information 
+ *                                            used by the interface for all chip 
+ *                                            interaction.
+ *
+ *    @return bool  True while the transition has not completed.
+ */
+#define CC1101StatePending(phyInfo) ((phyInfo)->transition.Complete != NULL)
+
 /**
  *  CC1101ReceiverOn - turn on the radio receiver.
  *
@@ -1232,6 +1411,35 @@ void CC1101Wakeup(struct sCC1101PhyInfo *phyInfo,
 // -----------------------------------------------------------------------------
 // Device interrupt
 
+/**
+ *  CC1101_STATIC_HAL - when defined to the name prefix of the platform SPI and
+ *  GDOx functions (e.g. A110x2500), the driver calls <prefix>SpiRead, 
+ *  <prefix>SpiWrite, ... directly rather than through the sCC1101Spi and 
+ *  sCC1101Gdo function pointers. The calls then resolve at compile time and 
+ *  may be inlined by whole program optimization.
+ *
+ *  Note: The gdo argument of the CC1101Gdo macros below is then the name prefix
+ *  of the GDOx pin functions (e.g. A110x2500Gdo0) instead of its interface. 
+ *  Leave CC1101_STATIC_HAL undefined to keep the function pointer interface 
+ *  (e.g. for a host emulator).
+ */
+#define CC1101_CONCAT(a, b)   CC1101_CONCAT_(a, b)
+#define CC1101_CONCAT_(a, b)  a##b
+
+#ifdef CC1101_STATIC_HAL
+void CC1101_CONCAT(CC1101_STATIC_HAL, SpiInit)(void);
+void CC1101_CONCAT(CC1101_STATIC_HAL, SpiRead)(unsigned char, unsigned char*, unsigned char);
+void CC1101_CONCAT(CC1101_STATIC_HAL, SpiWrite)(unsigned char, const unsigned char*, unsigned char);
+#endif
+
+#ifdef CC1101_STATIC_HAL
+#define CC1101GdoEvent(gdo, event)    (CC1101_CONCAT(gdo, Event)(event))
+#define CC1101GdoWaitForAssert(gdo)   CC1101_CONCAT(gdo, WaitForAssert)()
+#define CC1101GdoWaitForDeassert(gdo) CC1101_CONCAT(gdo, WaitForDeassert)()
+#define CC1101GdoEnable(gdo)          CC1101_CONCAT(gdo, Enable)(true)
+#define CC1101GdoDisable(gdo)         CC1101_CONCAT(gdo, Enable)(false)
+#define CC1101GdoGetState(gdo)        (CC1101_CONCAT(gdo, GetState)())
+#else
 /**
  *  CC1101GdoEvent - check if a GDOx event has occurred. This should be used in
  *  an I/O interrupt service routine to determine if a GDOx interrupt is pending
@@ -1304,5 +1512,6 @@ void CC1101Wakeup(struct sCC1101PhyInfo *phyInfo,
  *            configured for a deassert.
  */
 #define CC1101GdoGetState(gdo)  (gdo->GetState())
+#endif
 
 #endif  /* CC1101_H */
@@ -10,8 +10,8 @@
  *  A110LR09.h - Anaren Integrated Radio (AIR) module interface for the 
  *  A110LR09.
  *
- *  @version    1.0.01
- *  @date       28 Jan 2013
+ *  @version    1.0.02
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  For details on the interface, please see A110LR09.h
@@ -27,6 +27,10 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.02 : 19 Oct 2026
+ *  - A110LR09SetPaTable uses the last power level for entries past the end of
+ *  the power lookup table
+ *  - added the warm start of A110LR09Init (A110LR09_WARM_START)
  *	ver 1.0.01 : 28 Jan 2013
  *	- updated driver to compensate output power when changing configuration and
  *	initializing the driver
@@ -1250,11 +1254,140 @@ const struct sA110x2500PowerLookup gA110LR09PowerLookup[] = {
   #endif
 };
 
+#if defined( A110LR09_WARM_START )
+#if !defined( CC1101_REGISTER_SHADOW )
+#error "A110LR09 Error: A110LR09_WARM_START requires CC1101_REGISTER_SHADOW"
+#endif
+
+// Register bits that must still hold the default certified settings for the 
+// warm start (the bits outside of the modifiable configuration register masks).
+// The frequency synthesizer calibration results are not compared.
+const unsigned char gA110LR09WarmStartMask[CC1101_SHADOW_SIZE] = {
+  (unsigned char)~A110LR09_IOCFG2_MASK,   // IOCFG2
+  0x00,                                   // IOCFG1
+  0x00,                                   // IOCFG0
+  (unsigned char)~A110LR09_FIFOTHR_MASK,  // FIFOTHR
+  0xFF,                                   // SYNC1
+  0xFF,                                   // SYNC0
+  0x00,                                   // PKTLEN
+  (unsigned char)~A110LR09_PKTCTRL1_MASK, // PKTCTRL1
+  (unsigned char)~A110LR09_PKTCTRL0_MASK, // PKTCTRL0
+  0x00,                                   // ADDR
+  0x00,                                   // CHANNR
+  0xFF,                                   // FSCTRL1
+  0x00,                                   // FSCTRL0
+  0xFF,                                   // FREQ2
+  0xFF,                                   // FREQ1
+  0xFF,                                   // FREQ0
+  0xFF,                                   // MDMCFG4
+  0xFF,                                   // MDMCFG3
+  (unsigned char)~A110LR09_MDMCFG2_MASK,  // MDMCFG2
+  0xFF,                                   // MDMCFG1
+  0xFF,                                   // MDMCFG0
+  0xFF,                                   // DEVIATN
+  (unsigned char)~A110LR09_MCSM2_MASK,    // MCSM2
+  (unsigned char)~A110LR09_MCSM1_MASK,    // MCSM1
+  (unsigned char)~A110LR09_MCSM0_MASK,    // MCSM0
+  0xFF,                                   // FOCCFG
+  0xFF,                                   // BSCFG
+  0xFF,                                   // AGCCTRL2
+  (unsigned char)~A110LR09_AGCCTRL1_MASK, // AGCCTRL1
+  0xFF,                                   // AGCCTRL0
+  0x00,                                   // WOREVT1
+  0x00,                                   // WOREVT0
+  0x00,                                   // WORCTRL
+  0xFF,                                   // FREND1
+  0xFF,                                   // FREND0
+  0x00,                                   // FSCAL3
+  0x00,                                   // FSCAL2
+  0x00,                                   // FSCAL1
+  0x00,                                   // FSCAL0
+  0x00,                                   // RCCTRL1
+  0x00,                                   // RCCTRL0
+  0xFF,                                   // FSTEST
+  0xFF,                                   // PTEST
+  0xFF,                                   // AGCTEST (lost in SLEEP)
+  0xFF,                                   // TEST2 (lost in SLEEP)
+  0xFF,                                   // TEST1 (lost in SLEEP)
+  0xFF                                    // TEST0 (lost in SLEEP)
+};
+#endif
+
 // -----------------------------------------------------------------------------
 /**
  *  Private interface
  */
 
+#if defined( A110LR09_WARM_START )
+/**
+ *  A110LR09WarmStart - check if the CC110L still holds a configuration (e.g. 
+ *  after a watchdog reset or a brown-out of the processor only). The live 
+ *  registers are read into the register shadow and compared with the default
+ *  certified settings, ignoring the modifiable fields. If the configuration is
+ *  reused, the modifiable fields are restored to the certified settings (the
+ *  calibration registers are kept) and the FIFOs are flushed.
+ *
+ *    @param  phyInfo   A110LR09 module state information used by the 
+ *                      interface for all CC1101 chip interaction.
+ *    @param  config    Entry in the certified configuration lookup table.
+ *
+ *    @return True if the live configuration can be reused.
+ */
+bool A110LR09WarmStart(struct sA110LR09PhyInfo *phyInfo,
+                       const struct sA110x2500Lookup* config)
+{
+  const unsigned char *certified;
+  unsigned char i;
+  
+  if (config == NULL || !CC1101LoadShadow(&phyInfo->cc1101))
+  {
+    return false;
+  }
+  
+  certified = (const unsigned char*)&config->certified;
+  for (i = 0; i < CC1101_SHADOW_SIZE; i++)
+  {
+    if ((phyInfo->cc1101.shadow[i] ^ certified[i]) & gA110LR09WarmStartMask[i])
+    {
+      return false;
+    }
+  }
+  
+  // Restore the modifiable fields to the certified settings. The frequency
+  // synthesizer calibration of the chip is kept.
+  phyInfo->module.lookup = (struct sA110x2500Lookup*)config;
+  if (!CC1101Reconfigure(&phyInfo->cc1101, &config->certified))
+  {
+    return false;
+  }
+  
+  // Drop anything left in the FIFOs before the reset.
+  CC1101FlushRxFifo(&phyInfo->cc1101);
+  CC1101FlushTxFifo(&phyInfo->cc1101);
+  
+  return true;
+}
+#endif
+
+/**
+ *  A110LR09ConfigureOutput - set the initial power level and channel of the 
+ *  configuration in use.
+ *
+ *    @param  phyInfo   A110LR09 module state information used by the 
+ *                      interface for all CC1101 chip interaction.
+ *
+ *    @return Success of the operation.
+ */
+bool A110LR09ConfigureOutput(struct sA110LR09PhyInfo *phyInfo)
+{
+  // Set the initial power level (index 0 in the lookup or the maximum allowed).
+  memset(phyInfo->module.paTable, 0, A110LR09_PA_TABLE_SIZE);
+  A110LR09SetPaTable(phyInfo, phyInfo->module.paTable);
+  
+  // Set the initial channel (first approved).
+  return A110LR09SetChannr(phyInfo, phyInfo->module.lookup->certified.channr);
+}
+
 // -----------------------------------------------------------------------------
 /**
  *  Public interface
@@ -1269,6 +1402,20 @@ bool A110LR09Init(struct sA110LR09PhyInfo *phyInfo,
   // Setup CC1101 GDOx interface.
   CC1101GdoInit(&phyInfo->cc1101, gdo);
   
+  #if defined( A110LR09_WARM_START )
+  // Reuse the configuration left in the CC110L if it is still valid. The chip
+  // reset and the full register write are skipped; only the registers that
+  // differ from the default certified settings are rewritten, and FSCAL3 to
+  // FSCAL0 keep the last calibration (see CC1101Reconfigure). With the 
+  // certified MCSM0 (FS_AUTOCAL on IDLE to RX/TX) the chip still calibrates
+  // before its next RX or TX.
+  if (CC1101GetChip(&phyInfo->cc1101) == eCC1101Chip110L
+      && A110LR09WarmStart(phyInfo, A110LR09GetLookup(0)))
+  {
+    return A110LR09ConfigureOutput(phyInfo);
+  }
+  #endif
+  
   // Verify that the CC110L is in a known (IDLE) state.
   CC1101Strobe(&phyInfo->cc1101, CC1101_SRES);
   
@@ -1342,17 +1489,7 @@ bool A110LR09Configure(struct sA110LR09PhyInfo *phyInfo,
     return false;
   }
 
-  // Set the initial power level (index 0 in the lookup or the maximum allowed).
-  memset(phyInfo->module.paTable, 0, A110LR09_PA_TABLE_SIZE);
-  A110LR09SetPaTable(phyInfo, phyInfo->module.paTable);
-  
-  // Set the initial channel (first approved).
-  if (!A110LR09SetChannr(phyInfo, phyInfo->module.lookup->certified.channr))
-  {
-    return false;
-  }
-  
-  return true;
+  return A110LR09ConfigureOutput(phyInfo);
 }
 
 void A110LR09SetPaTable(struct sA110LR09PhyInfo *phyInfo, 
@@ -1365,7 +1502,7 @@ void A110LR09SetPaTable(struct sA110LR09PhyInfo *phyInfo,
   // does not exceed the maximum allowed.
 	for (i = 0; i < A110LR09_PA_TABLE_SIZE; i++)
 	{
-		if (powerEntry[i] > A110LR09GetPowerLookupSize())
+		if (powerEntry[i] >= A110LR09GetPowerLookupSize())
 		{
 			// Check if the last entry in the lookup table exceeds the maximum power
 			// level.
@@ -12,8 +12,8 @@
  *  A110LR09.h - Anaren Integrated Radio (AIR) module interface for the 
  *  A110LR09.
  *
- *  @version    1.0.01
- *  @date       28 Jan 2013
+ *  @version    1.0.02
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  The A110LR09 module operates in the 868/915MHz dual band and incorporates 
@@ -182,13 +182,15 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.02 : 19 Oct 2026
+ *  - added the warm start of A110LR09Init (A110LR09_WARM_START)
  *	ver 1.0.01 : 28 Jan 2013
  *	- updated driver to compensate output power when changing configuration and
  *	initializing the driver
  *  ver 1.0.00 : 16 Jan 2013
  *  - initial release
  */
-#define A110LR09_INFO "A110LR09 1.0.01"
+#define A110LR09_INFO "A110LR09 1.0.02"
 
 #ifndef bool
 #define bool unsigned char
@@ -287,6 +289,11 @@ struct sA110LR09PhyInfo
  *  default certified configuration (index 0 in the lookup) and default power
  *  level (index 0 or maximum allowed) will be set.
  *
+ *  Note: With A110LR09_WARM_START defined (requires CC1101_REGISTER_SHADOW), a
+ *  CC110L that still holds the default certified configuration (modifiable 
+ *  fields aside) is not reset. Its FIFOs are flushed and only the registers 
+ *  that differ are rewritten.
+ *
  *    @param  phyInfo             A110LR09 module state information used by the 
  *                                interface for all CC1101 chip interaction.
  *    @param  spi                 CC1101 SPI interface function pointers. This 
@@ -10,8 +10,8 @@
  *  A110x2500PhyBridge.c - physical bridge implementation using A110x2500-based 
  *		modules.
  *
- *  @version    1.0.01
- *  @date       17 Oct 2012
+ *  @version    1.0.02
+ *  @date       19 Oct 2026
  *  @author     B Blincoe, bblincoe@anaren.com
  *
  *  assumptions
@@ -26,6 +26,32 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.02 : 19 Oct 2026
+ *  - PhyTransmit performs a clear channel assessment before transmitting when
+ *  PROTOCOL_USE_CSMA is defined (End Point only); added PhyListen to turn the
+ *  receiver on ahead of the assessment
+ *  - added PhyGetAirtime
+ *  - implemented PhyGetInstantSignalStrength (averaged RSSI) and added
+ *  PhyScanChannels
+ *  - PhyConfigure keeps the channel, address filter and power level, and 
+ *  recalculates the Rx timeout with the new configuration
+ *  - implemented PhySetOutputPower (power in dBm) and added PhyGetOutputPower
+ *  - PhyCalculateRxTimeout uses the airtime of the largest data stream (the
+ *  preamble and sync word were dropped and the baud rate truncated); added
+ *  PhyGetDutyCycle
+ *  - data streams larger than the FIFO are refilled/drained on the GDO2 FIFO
+ *  threshold interrupt (PHY_USE_FIFO_STREAMING); added the GDO2 interface
+ *  - PhyGetDataStream reads the data stream in place with a single RX FIFO 
+ *  burst sized by a single RXBYTES read
+ *  - added PhyFilterInit; PhyGetDataStream reads the data stream header first
+ *  and flushes the RX FIFO when the filter rejects the data stream or its 
+ *  length field does not match the RX FIFO, so the burst cannot overrun the 
+ *  receive buffer
+ *  - PhySyncEopIsr no longer spins on TX_END; the transition to the TXOFF 
+ *  state completes on the physical timer tick (PhyTransmitComplete)
+ *  - the GDOx calls resolve at compile time with CC1101_STATIC_HAL (PHY_GDO0,
+ *  PHY_GDO2)
+ *  - added a host test stub for PhyGetDataStream (TEST_PHY_BRIDGE_RX)
  *  ver 1.0.01 : 17 Oct 2012
  *  - updated internal documentation; comments revised
  *  - added a test example (stub) to perform various frame operations
@@ -46,11 +72,16 @@
 #define PHYINFO_CAST(phyInfo)               ((struct sA1101R04PhyInfo*)phyInfo)
 #define A1101GetLookup(entry)               A1101R04GetLookup(entry)
 #define A1101GetLookupSize()                A1101R04GetLookupSize()
+#define A1101GetPowerLookup(entry)          A1101R04GetPowerLookup(entry)
+#define A1101GetPowerLookupSize()           A1101R04GetPowerLookupSize()
 #define A1101Init(phyInfo, spi, gdo)\
   A1101R04Init(phyInfo, spi, gdo)
 #define A1101Configure(phyInfo, config)\
   A1101R04Configure(phyInfo, config)
 #define A1101Wakeup(phyInfo)                A1101R04Wakeup(phyInfo)
+#define A1101SetIocfg2(phyInfo, iocfg2)     A1101R04SetIocfg2(phyInfo, iocfg2)
+#define A1101SetFifothr(phyInfo, fifothr)   A1101R04SetFifothr(phyInfo, fifothr)
+#define A1101SetPktlen(phyInfo, pktlen)     A1101R04SetPktlen(phyInfo, pktlen)
 #define A1101SetPktctrl1(phyInfo, pktctrl1) A1101R04SetPktctrl1(phyInfo, pktctrl1)
 #define A1101SetMcsm0(phyInfo, mcsm0)       A1101R04SetMcsm0(phyInfo, mcsm0)
 #define A1101SetAddr(phyInfo, addr)         A1101R04SetAddr(phyInfo, addr)
@@ -65,11 +96,16 @@
 #define PHYINFO_CAST(phyInfo)               ((struct sA1101R08PhyInfo*)phyInfo)
 #define A1101GetLookup(entry)               A1101R08GetLookup(entry)
 #define A1101GetLookupSize()                A1101R08GetLookupSize()
+#define A1101GetPowerLookup(entry)          A1101R08GetPowerLookup(entry)
+#define A1101GetPowerLookupSize()           A1101R08GetPowerLookupSize()
 #define A1101Init(phyInfo, spi, gdo)\
   A1101R08Init(phyInfo, spi, gdo)
 #define A1101Configure(phyInfo, config)\
   A1101R08Configure(phyInfo, config)
 #define A1101Wakeup(phyInfo)                A1101R08Wakeup(phyInfo)
+#define A1101SetIocfg2(phyInfo, iocfg2)     A1101R08SetIocfg2(phyInfo, iocfg2)
+#define A1101SetFifothr(phyInfo, fifothr)   A1101R08SetFifothr(phyInfo, fifothr)
+#define A1101SetPktlen(phyInfo, pktlen)     A1101R08SetPktlen(phyInfo, pktlen)
 #define A1101SetPktctrl1(phyInfo, pktctrl1) A1101R08SetPktctrl1(phyInfo, pktctrl1)
 #define A1101SetMcsm0(phyInfo, mcsm0)       A1101R08SetMcsm0(phyInfo, mcsm0)
 #define A1101SetAddr(phyInfo, addr)         A1101R08SetAddr(phyInfo, addr)
@@ -84,11 +120,16 @@
 #define PHYINFO_CAST(phyInfo)               ((struct sA1101R09PhyInfo*)phyInfo)
 #define A1101GetLookup(entry)               A1101R09GetLookup(entry)
 #define A1101GetLookupSize()                A1101R09GetLookupSize()
+#define A1101GetPowerLookup(entry)          A1101R09GetPowerLookup(entry)
+#define A1101GetPowerLookupSize()           A1101R09GetPowerLookupSize()
 #define A1101Init(phyInfo, spi, gdo)\
   A1101R09Init(phyInfo, spi, gdo)
 #define A1101Configure(phyInfo, config)\
   A1101R09Configure(phyInfo, config)
 #define A1101Wakeup(phyInfo)                A1101R09Wakeup(phyInfo)
+#define A1101SetIocfg2(phyInfo, iocfg2)     A1101R09SetIocfg2(phyInfo, iocfg2)
+#define A1101SetFifothr(phyInfo, fifothr)   A1101R09SetFifothr(phyInfo, fifothr)
+#define A1101SetPktlen(phyInfo, pktlen)     A1101R09SetPktlen(phyInfo, pktlen)
 #define A1101SetPktctrl1(phyInfo, pktctrl1) A1101R09SetPktctrl1(phyInfo, pktctrl1)
 #define A1101SetMcsm0(phyInfo, mcsm0)       A1101R09SetMcsm0(phyInfo, mcsm0)
 #define A1101SetAddr(phyInfo, addr)         A1101R09SetAddr(phyInfo, addr)
@@ -103,11 +144,16 @@
 #define PHYINFO_CAST(phyInfo)               ((struct sA110LR09PhyInfo*)phyInfo)
 #define A1101GetLookup(entry)               A110LR09GetLookup(entry)
 #define A1101GetLookupSize()                A110LR09GetLookupSize()
+#define A1101GetPowerLookup(entry)          A110LR09GetPowerLookup(entry)
+#define A1101GetPowerLookupSize()           A110LR09GetPowerLookupSize()
 #define A1101Init(phyInfo, spi, gdo)\
   A110LR09Init(phyInfo, spi, gdo)
 #define A1101Configure(phyInfo, config)\
   A110LR09Configure(phyInfo, config)
 #define A1101Wakeup(phyInfo)                A110LR09Wakeup(phyInfo)
+#define A1101SetIocfg2(phyInfo, iocfg2)     A110LR09SetIocfg2(phyInfo, iocfg2)
+#define A1101SetFifothr(phyInfo, fifothr)   A110LR09SetFifothr(phyInfo, fifothr)
+#define A1101SetPktlen(phyInfo, pktlen)     A110LR09SetPktlen(phyInfo, pktlen)
 #define A1101SetPktctrl1(phyInfo, pktctrl1) A110LR09SetPktctrl1(phyInfo, pktctrl1)
 #define A1101SetMcsm0(phyInfo, mcsm0)       A110LR09SetMcsm0(phyInfo, mcsm0)
 #define A1101SetAddr(phyInfo, addr)         A110LR09SetAddr(phyInfo, addr)
@@ -122,11 +168,16 @@
 #define PHYINFO_CAST(phyInfo)               ((struct sA2500R24PhyInfo*)phyInfo)
 #define A1101GetLookup(entry)               A2500R24GetLookup(entry)
 #define A1101GetLookupSize()                A2500R24GetLookupSize()
+#define A1101GetPowerLookup(entry)          A2500R24GetPowerLookup(entry)
+#define A1101GetPowerLookupSize()           A2500R24GetPowerLookupSize()
 #define A1101Init(phyInfo, spi, gdo)\
   A2500R24Init(phyInfo, spi, gdo)
 #define A1101Configure(phyInfo, config)\
   A2500R24Configure(phyInfo, config)
 #define A1101Wakeup(phyInfo)                A2500R24Wakeup(phyInfo)
+#define A1101SetIocfg2(phyInfo, iocfg2)     A2500R24SetIocfg2(phyInfo, iocfg2)
+#define A1101SetFifothr(phyInfo, fifothr)   A2500R24SetFifothr(phyInfo, fifothr)
+#define A1101SetPktlen(phyInfo, pktlen)     A2500R24SetPktlen(phyInfo, pktlen)
 #define A1101SetPktctrl1(phyInfo, pktctrl1) A2500R24SetPktctrl1(phyInfo, pktctrl1)
 #define A1101SetMcsm0(phyInfo, mcsm0)       A2500R24SetMcsm0(phyInfo, mcsm0)
 #define A1101SetAddr(phyInfo, addr)         A2500R24SetAddr(phyInfo, addr)
@@ -137,10 +188,57 @@
   A2500R24ConvertRssiToDbm(phyInfo, rssi)
 #endif
 
-// Note: This is used to calculate SYNC word timeout. It is common for all
-// supported A110X/2500-based platforms.
+// Note: This is used to calculate the airtime (SYNC word timeout and duty 
+// cycle). It is common for all supported A110X/2500-based platforms.
 #define PHY_PREAMBLE_LENGTH   4             // Length of preamble in bytes
 #define PHY_SYNC_LENGTH       4             // Length of sync in bytes
+#define PHY_CRC_LENGTH        2             // Length of CRC in bytes
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+// Consecutive PKTSTATUS reads that must report a clear channel
+#ifndef PHY_CCA_SAMPLES
+#define PHY_CCA_SAMPLES       8
+#endif
+
+// Maximum number of MARCSTATE reads while the radio turns around from RX to TX
+// after STX
+#ifndef PHY_CCA_TX_TIMEOUT
+#define PHY_CCA_TX_TIMEOUT    32
+#endif
+#endif
+
+#if defined( PHY_USE_FIFO_STREAMING )
+// FIFO threshold streaming. FIFOTHR.FIFO_THR = 7 sets the TX FIFO threshold to
+// 33 bytes and the RX FIFO threshold to 32 bytes.
+#define PHY_STREAM_FIFO_THR   7
+#define PHY_STREAM_TX_CHUNK   (CC1101_TXFIFO_SIZE - 33) // Free TX FIFO bytes once below the threshold
+#define PHY_STREAM_RX_CHUNK   (32 - 1)                  // RX FIFO bytes read at the threshold
+
+// GDO2 output pin configuration (IOCFG2.GDO2_CFG)
+#define PHY_GDO2_RX_THRESHOLD 0x00  // RX FIFO filled at or above the threshold
+#define PHY_GDO2_TX_THRESHOLD 0x02  // TX FIFO filled at or above the threshold
+#endif
+
+// RSSI reads averaged by a signal strength measurement
+#ifndef PHY_RSSI_SAMPLES
+#define PHY_RSSI_SAMPLES      8
+#endif
+
+// Maximum number of MARCSTATE reads while waiting for the receiver to settle
+#define PHY_RSSI_RX_TIMEOUT   CC1101_MAX_TIMEOUT
+
+// Physical timer ticks (ms) allowed for the radio to leave TX_END
+#define PHY_TX_END_TIMEOUT    2
+
+// GDOx pins passed to the CC1101Gdo macros. They resolve to the platform pin 
+// functions with CC1101_STATIC_HAL, otherwise to the GDOx interface pointers.
+#if defined( CC1101_STATIC_HAL )
+#define PHY_GDO0              CC1101_CONCAT(CC1101_STATIC_HAL, Gdo0)
+#define PHY_GDO2              CC1101_CONCAT(CC1101_STATIC_HAL, Gdo2)
+#else
+#define PHY_GDO0              gPhyInfo->cc1101.gdo[0]
+#define PHY_GDO2              gPhyInfo->cc1101.gdo[2]
+#endif
 
 // -----------------------------------------------------------------------------
 /**
@@ -164,12 +262,31 @@ const struct sCC1101Gdo gA1101Gdo0 = {
   A110x2500Gdo0Enable           // Radio GDO0 interrupt enable
 };
 
+#if defined( PHY_USE_FIFO_STREAMING )
+// CC1101 GDO2 interface
+const struct sCC1101Gdo gA1101Gdo2 = {
+  A110x2500Gdo2Init,            // Radio GDO2 interrupt initialization
+  A110x2500Gdo2Event,           // Radio GDO2 interrupt event
+  A110x2500Gdo2WaitForAssert,   // Radio GDO2 interrupt set polarity: assert
+  A110x2500Gdo2WaitForDeassert, // Radio GDO2 interrupt set polarity: deassert
+  A110x2500Gdo2GetState,        // Radio GDO2 interrupt get current polarity (assert, deassert)
+  A110x2500Gdo2Enable           // Radio GDO2 interrupt enable
+};
+
+// CC1101 GDOx interface
+const struct sCC1101Gdo *gA1101Gdo[3] = { 
+  &gA1101Gdo0,  // Uses GDO0 for SYNC/EOP
+  NULL,         // Does not use GDO1
+  &gA1101Gdo2   // Uses GDO2 for the FIFO threshold
+};
+#else
 // CC1101 GDOx interface
 const struct sCC1101Gdo *gA1101Gdo[3] = { 
   &gA1101Gdo0,  // Uses GDO0 exclusively
   NULL,         // Does not use GDO1
   NULL          // Does not use GDO2
 };
+#endif
 
 #if defined( A1101R04_MODULE )
 static struct sA1101R04PhyInfo gA1101r04PhyInfo;
@@ -191,6 +308,9 @@ static struct sA2500R24PhyInfo *gPhyInfo = &gA2500r24PhyInfo;
 // Physical device and associated data stream
 static struct sPhyDevice gPhyDevice;
 
+// Selected entry of the power lookup table
+static unsigned char gPhyPowerEntry = 0;
+
 // -----------------------------------------------------------------------------
 /**
  *  Private interface
@@ -199,25 +319,18 @@ static struct sPhyDevice gPhyDevice;
 #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_RX_TIMEOUT )
 /**
  *  PhyCalculateRxTimeout - calculate the number of ticks required to register
- *  as an Rx timeout. The value is calculated as follows,
+ *  as an Rx timeout with the current configuration. The value is calculated as
+ *  follows,
  *
- *      TIME = ((((PREAMBLE + SYNC) * 8) + (PAYLOAD * 8)) * (1 / BAUD)) + OFFSET
+ *      TIME = AIRTIME(largest data stream) + OFFSET
  *
- *  The calculation below differs only because time needs to be in milliseconds
- *  and the baud rate is stored along with a scale factor to represent the true
- *  baud rate. For instance, 1.2kBaud is stored as 12 with a scale factor of
- *  100.
- *
- *    @param  baudRate      Scaled baud rate value.
- *    @param  scaleFactor   Baud rate scale factor to recover true baud rate.
+ *  The airtime includes the preamble, sync word, data stream header and CRC
+ *  (see PhyGetAirtime).
  */
-void PhyCalculateRxTimeout(unsigned int baudRate, unsigned int scaleFactor)
+void PhyCalculateRxTimeout()
 {
-  gPhyDevice.timer.rxTimeout.compare = ((PHY_PREAMBLE_LENGTH + PHY_SYNC_LENGTH) * 8);
-  gPhyDevice.timer.rxTimeout.compare = (PHY_MAX_TXFIFO_SIZE * 8);
-  gPhyDevice.timer.rxTimeout.compare *= (1000 / baudRate);// Convert time to millisecond ticks
-  gPhyDevice.timer.rxTimeout.compare /= scaleFactor;      // Scale the result
-  gPhyDevice.timer.rxTimeout.compare += 1;                // Round up to the next timer tick
+  gPhyDevice.timer.rxTimeout.compare = 
+    PhyGetAirtime(PROTOCOL_DATASTREAM_MAX_SIZE - PROTOCOL_DATASTREAM_HEADER_LENGTH);
   
   // Add an offset. Double the compare value and add processing overhead estimate.
   // TODO: Determine an appropriate processing overhead estimate value.
@@ -279,54 +392,303 @@ void PhyDataStreamBuild(struct sCC1101PhyInfo *phyInfo,
   gPhyDevice.stream.header.length = length;
   gPhyDevice.stream.dataField = dataField;
 
-  // Flush the TX FIFO before writing any new data to it.
-  CC1101FlushTxFifo(phyInfo);  
+  #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+  // SFTX is only accepted in IDLE. PhyListen flushed the TX FIFO before
+  // turning the receiver on.
+  if (!gPhyDevice.status.listening)
+  #endif
+  {
+    // Flush the TX FIFO before writing any new data to it.
+    CC1101FlushTxFifo(phyInfo);  
+  }
       
   // Write the length field to the TX FIFO.
   CC1101WriteTxFifo(phyInfo, 
                     &gPhyDevice.stream.header.length,
                     1);
+  
+  #if defined( PHY_USE_FIFO_STREAMING )
+  // Only the start of a long data stream fits into the TX FIFO. The rest is
+  // written as the TX FIFO drains (see PhyStreamTransmit).
+  if (length > (CC1101_TXFIFO_SIZE - PROTOCOL_DATASTREAM_HEADER_LENGTH))
+  {
+    length = CC1101_TXFIFO_SIZE - PROTOCOL_DATASTREAM_HEADER_LENGTH;
+  }
+  gPhyDevice.stream.offset = PROTOCOL_DATASTREAM_HEADER_LENGTH + length;
+  #endif
+  
   // Write the address and data field to the TX FIFO.
   CC1101WriteTxFifo(phyInfo,
                     gPhyDevice.stream.dataField,
-                    gPhyDevice.stream.header.length);
+                    length);
 }
 
 /**
  *  PhyGetDataStream - strip off the Physical header/footer information and
  *  retrieve the data field.
+ *
+ *  The radio leaves RX at the end of the packet, so the RX FIFO holds the rest
+ *  of a single data stream (length field, data field and appended status). One
+ *  RXBYTES read sizes a single burst read of all of it. The data stream is read
+ *  in place around the data field (see PhyReceiverOn).
  */
 void PhyGetDataStream(void)
 {
   PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
-  volatile unsigned char rxBytes = CC1101ReadRxFifo(&phyInfo->cc1101, 
-                                                    &gPhyDevice.stream.header.length, 
-                                                    1);
+  unsigned char *stream = gPhyDevice.stream.dataField - PROTOCOL_DATASTREAM_HEADER_LENGTH;
+  unsigned int offset = 0;              // Data stream bytes already read
+  unsigned int size;                    // Data stream size (status included)
+  unsigned char rxBytes;
   
-  // Check if the RX FIFO has any data in it. If not, exit early as the RX FIFO
-  // does not have any useful data in it. A bogus interrupt has occurred.
-  if (rxBytes)
+  #if defined( PHY_USE_FIFO_STREAMING )
+  // The start of the data stream may already have been read during the
+  // reception (see PhyStreamReceive).
+  offset = gPhyDevice.stream.offset;
+  gPhyDevice.stream.offset = 0;
+  #endif
+  
+  rxBytes = CC1101GetRxFifoCount(&phyInfo->cc1101);
+  
+  // Check if the RX FIFO holds a data stream. If not, a bogus interrupt has 
+  // occurred or the RX FIFO has overflowed.
+  if (!(rxBytes & CC1101_RXFIFO_OVERFLOW)
+      && (offset + rxBytes) >= PROTOCOL_DATASTREAM_OVERHEAD)
   {
-    // Read the data field.
-    CC1101ReadRxFifo(&phyInfo->cc1101, 
-                     gPhyDevice.stream.dataField, 
-                     gPhyDevice.stream.header.length);
+    size = offset + rxBytes;
+    
+    // Read the length field and the start of the data field first and let the 
+    // filter reject data streams meant for another device. A rejected data 
+    // stream is flushed (the radio is IDLE after the end of packet) rather 
+    // than clocked out over SPI.
+    if (gPhyDevice.status.DataStreamFilter != NULL
+        && size >= (unsigned char)(PROTOCOL_DATASTREAM_OVERHEAD + gPhyDevice.status.filterLength))
+    {
+      if (offset < (unsigned char)(PROTOCOL_DATASTREAM_HEADER_LENGTH + gPhyDevice.status.filterLength))
+      {
+        CC1101ReadRegisters(&phyInfo->cc1101, CC1101_RXFIFO, stream + offset, 
+          (PROTOCOL_DATASTREAM_HEADER_LENGTH + gPhyDevice.status.filterLength) - offset);
+        offset = PROTOCOL_DATASTREAM_HEADER_LENGTH + gPhyDevice.status.filterLength;
+      }
+      
+      // The filter also rejects a length field larger than the receive buffer,
+      // and the length field must account for the whole RX FIFO, so that the 
+      // burst below cannot overrun the buffer.
+      if (!gPhyDevice.status.DataStreamFilter(gPhyDevice.stream.dataField, stream[0])
+          || (unsigned int)(stream[0] + PROTOCOL_DATASTREAM_OVERHEAD) != size)
+      {
+        CC1101FlushRxFifo(&phyInfo->cc1101);
+        gPhyDevice.stream.header.length = 0;
+        return;
+      }
+    }
+    
+    // Read the rest of the length field, the data field and the appended 
+    // status (RSSI, LQI, and CRC_OK).
+    CC1101ReadRegisters(&phyInfo->cc1101, CC1101_RXFIFO, stream + offset, size - offset);
+    gPhyDevice.stream.header.length = stream[0];
+    
+    if ((unsigned int)(gPhyDevice.stream.header.length + PROTOCOL_DATASTREAM_OVERHEAD) == size)
+    {
+      gPhyDevice.stream.footer.rssi = 
+        (signed char)gPhyDevice.stream.dataField[gPhyDevice.stream.header.length];
+      gPhyDevice.stream.footer.status = 
+        gPhyDevice.stream.dataField[gPhyDevice.stream.header.length + 1];
+      
+      // Convert the RSSI value to an absolute power level.
+      {
+        signed char rssi = gPhyDevice.stream.footer.rssi;
+        gPhyDevice.stream.footer.rssi = (signed int)(A1101ConvertRssiToDbm(phyInfo, rssi) + 1) >> 1;                                                   
+      }
+      return;
+    }
+  }
+  
+  gPhyDevice.stream.header.length = 0;
+}
 
-    // Read the appended status (RSSI, LQI, and CRC_OK).
-    CC1101ReadRxFifo(&phyInfo->cc1101, 
-                     (unsigned char*)&gPhyDevice.stream.footer.rssi, 
-                     2);
+#if defined( PHY_USE_FIFO_STREAMING )
+/**
+ *  PhyStreamConfigure - set the FIFO thresholds used for streaming and let the
+ *  hardware drop data streams larger than PROTOCOL_DATASTREAM_MAX_SIZE (the
+ *  receive buffer is not larger).
+ *
+ *    @param  phyInfo   Physical information structure.
+ */
+void PhyStreamConfigure(PHYINFO phyInfo)
+{
+  A1101SetFifothr(phyInfo, ((phyInfo->module.lookup->certified.fifothr & ~(CC1101_FIFO_THR))
+                            | PHY_STREAM_FIFO_THR));
+  A1101SetPktlen(phyInfo, PROTOCOL_DATASTREAM_MAX_SIZE);
+}
+#endif
+
+#if defined( PHY_USE_FIFO_STREAMING )
+/**
+ *  PhyStreamStart - route the FIFO threshold of the next operation to GDO2 and
+ *  restart the data stream offset. The GDO2 interrupt is left disabled.
+ *
+ *  In TX, GDO2 deasserts once the TX FIFO drains below its threshold. In RX,
+ *  GDO2 asserts once the RX FIFO fills up to its threshold.
+ *
+ *    @param  phyInfo   Physical information structure.
+ *    @param  transmit  True for a transmission, false for a reception.
+ */
+void PhyStreamStart(PHYINFO phyInfo, bool transmit)
+{
+  CC1101GdoDisable(PHY_GDO2);
+  gPhyDevice.stream.offset = 0;
+  
+  if (transmit)
+  {
+    A1101SetIocfg2(phyInfo, PHY_GDO2_TX_THRESHOLD);
+    CC1101GdoWaitForDeassert(PHY_GDO2);
+  }
+  else
+  {
+    A1101SetIocfg2(phyInfo, PHY_GDO2_RX_THRESHOLD);
+    CC1101GdoWaitForAssert(PHY_GDO2);
+  }
+}
+#endif
 
-    // Convert the RSSI value to an absolute power level.
+#if defined( PHY_USE_FIFO_STREAMING )
+/**
+ *  PhyStreamTransmit - write the next part of the data stream to the TX FIFO
+ *  once it has drained below its threshold. The GDO2 interrupt is disabled
+ *  when the whole data stream has been written.
+ *
+ *    @param  phyInfo   Physical information structure.
+ */
+void PhyStreamTransmit(PHYINFO phyInfo)
+{
+  unsigned int count = PROTOCOL_DATASTREAM_HEADER_LENGTH + gPhyDevice.stream.header.length;
+  
+  // A threshold event left over from the end of the data stream.
+  if (gPhyDevice.stream.offset >= count)
+  {
+    return;
+  }
+  
+  count -= gPhyDevice.stream.offset;
+  if (count > PHY_STREAM_TX_CHUNK)
+  {
+    count = PHY_STREAM_TX_CHUNK;
+  }
+  
+  CC1101WriteTxFifo(&phyInfo->cc1101,
+                    gPhyDevice.stream.dataField 
+                    + (gPhyDevice.stream.offset - PROTOCOL_DATASTREAM_HEADER_LENGTH),
+                    count);
+  gPhyDevice.stream.offset += count;
+  
+  if (gPhyDevice.stream.offset >= (unsigned int)(PROTOCOL_DATASTREAM_HEADER_LENGTH + gPhyDevice.stream.header.length))
+  {
+    CC1101GdoDisable(PHY_GDO2);
+  }
+}
+#endif
+
+#if defined( PHY_USE_FIFO_STREAMING )
+/**
+ *  PhyStreamReceive - read the data stream received so far once the RX FIFO 
+ *  has filled up to its threshold. The data stream is read in place, the first
+ *  read includes the length field.
+ *
+ *  Note: The RX FIFO must not be emptied before the end of the packet. One byte
+ *  is always left in it; the end of the data stream and the appended status are
+ *  read by PhyGetDataStream.
+ *
+ *    @param  phyInfo   Physical information structure.
+ */
+void PhyStreamReceive(PHYINFO phyInfo)
+{
+  // A threshold event left over from the last data stream reads nothing (the
+  // RX FIFO has been read completely).
+  gPhyDevice.stream.offset += 
+    CC1101ReadRxFifo(&phyInfo->cc1101,
+                     (gPhyDevice.stream.dataField - PROTOCOL_DATASTREAM_HEADER_LENGTH) 
+                     + gPhyDevice.stream.offset,
+                     PHY_STREAM_RX_CHUNK);
+}
+#endif
+
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+/**
+ *  PhyClearChannelAssessment - sample the clear channel assessment (CCA)
+ *  status. The receiver was turned on by PhyListen at least one timer tick
+ *  earlier and is not waited for here, as this runs from the timer interrupt.
+ *  A receiver that has not settled into RX reports a busy channel. The
+ *  certified configurations set MCSM1.CCA_MODE to "RSSI below threshold unless
+ *  currently receiving a packet". The radio is left in RX so that a following
+ *  STX strobe is again gated by the hardware CCA.
+ *
+ *    @param  phyInfo   Physical information structure.
+ *
+ *    @return True if the channel is clear, otherwise false.
+ */
+bool PhyClearChannelAssessment(PHYINFO phyInfo)
+{
+  unsigned char sample;
+  
+  if (CC1101GetMarcState(&phyInfo->cc1101) != eCC1101MarcStateRx)
+  {
+    return false;
+  }
+  
+  for (sample = 0; sample < PHY_CCA_SAMPLES; sample++)
+  {
+    if (!(CC1101GetRegister(&phyInfo->cc1101, CC1101_PKTSTATUS) & CC1101_PKTSTATUS_CCA))
     {
-      signed char rssi = gPhyDevice.stream.footer.rssi;
-      gPhyDevice.stream.footer.rssi = (signed int)(A1101ConvertRssiToDbm(phyInfo, rssi) + 1) >> 1;                                                   
+      return false;
     }
   }
-  else
+  
+  return true;
+}
+
+/**
+ *  PhyTransmitAccepted - wait for the radio to leave RX after STX. With CCA
+ *  enabled the radio ignores STX and stays in RX if the channel became busy
+ *  after it was sampled. A radio still in RX with a clear CCA status is
+ *  turning around, so the state is read again (at most PHY_CCA_TX_TIMEOUT
+ *  times).
+ *
+ *    @param  phyInfo   Physical information structure.
+ *
+ *    @return True if the radio has left RX to transmit, otherwise false.
+ */
+bool PhyTransmitAccepted(PHYINFO phyInfo)
+{
+  unsigned char tick;
+  
+  for (tick = 0; tick < PHY_CCA_TX_TIMEOUT; tick++)
   {
-    gPhyDevice.stream.header.length = 0;
+    if (CC1101GetMarcState(&phyInfo->cc1101) != eCC1101MarcStateRx)
+    {
+      return true;
+    }
+    
+    if (!(CC1101GetRegister(&phyInfo->cc1101, CC1101_PKTSTATUS) & CC1101_PKTSTATUS_CCA))
+    {
+      return false;
+    }
   }
+  
+  return false;
+}
+#endif
+
+/**
+ *  PhyApplyOutputPower - write the selected power level to the PA table. The
+ *  module limits the level to the maximum power of the configuration.
+ */
+void PhyApplyOutputPower()
+{
+  PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+  unsigned char powerEntry[sizeof(phyInfo->module.paTable)];
+  
+  memset(powerEntry, gPhyPowerEntry, sizeof(powerEntry));
+  A1101SetPaTable(phyInfo, powerEntry);
 }
 
 // -----------------------------------------------------------------------------
@@ -342,20 +704,27 @@ bool PhyInit(unsigned char(*DataStreamSent)(void),
   // Initialize the physical bridge device and data stream structures.
   gPhyDevice.phyInfo = (void*)gPhyInfo;
   gPhyDevice.status.transmitting = false;
+  gPhyDevice.status.filterLength = 0;
+  gPhyDevice.status.DataStreamFilter = NULL;
   gPhyDevice.timer.Generic = NULL;
 
   gPhyDevice.stream.header.length = 0;
   gPhyDevice.stream.dataField = NULL;
+  #if defined( PHY_USE_FIFO_STREAMING )
+  gPhyDevice.stream.offset = 0;
+  #endif
   gPhyDevice.stream.footer.rssi = 0;
   gPhyDevice.stream.footer.status = 0;
   
+  // The module starts with the first power level of the lookup table.
+  gPhyPowerEntry = 0;
+  
   // Initialize the physical layer structures and hardware.
   phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
   
   #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_RX_TIMEOUT )
   // Calculate SYNC timeout value.
-  PhyCalculateRxTimeout(phyInfo->module.lookup->baudRate.value,
-                          phyInfo->module.lookup->baudRate.scaleFactor);
+  PhyCalculateRxTimeout();
   #endif
   
   // Register a callback routine for the upper layer when sending data stream
@@ -376,6 +745,10 @@ bool PhyInit(unsigned char(*DataStreamSent)(void),
   {
     return false;
   }
+  
+  #if defined( PHY_USE_FIFO_STREAMING )
+  PhyStreamConfigure(phyInfo);
+  #endif
 
   // Set the default local device address to broadcast.
   A1101SetAddr(phyInfo, 0x00);
@@ -385,12 +758,15 @@ bool PhyInit(unsigned char(*DataStreamSent)(void),
 
 void PhyEnable()
 {
-  CC1101GdoEnable(PHYINFO_CAST(gPhyDevice.phyInfo)->cc1101.gdo[0]);
+  CC1101GdoEnable(PHY_GDO0);
 }
 
 void PhyDisable()
 {
-  CC1101GdoDisable(PHYINFO_CAST(gPhyDevice.phyInfo)->cc1101.gdo[0]);
+  CC1101GdoDisable(PHY_GDO0);
+  #if defined( PHY_USE_FIFO_STREAMING )
+  CC1101GdoDisable(PHY_GDO2);
+  #endif
 }
 
 // -----------------------------------------------------------------------------
@@ -399,19 +775,43 @@ void PhyDisable()
 bool PhyConfigure(unsigned char config)
 {
   PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+  unsigned char channr;
+  unsigned char addr;
+  unsigned char pktctrl1;
 
   // Set physical hardware to an active state.
   PhyActiveMode();
   
+  // The certified settings overwrite the channel, the address filter and the
+  // PA table. Keep the current values (the power level is kept as an entry of
+  // the power lookup table).
+  channr = CC1101GetRegister(&phyInfo->cc1101, CC1101_REG_CHANNR);
+  addr = CC1101GetRegister(&phyInfo->cc1101, CC1101_REG_ADDR);
+  pktctrl1 = CC1101GetRegister(&phyInfo->cc1101, CC1101_REG_PKTCTRL1);
+  
+  // Completely reconfigure all registers to the certified settings with the 
+  // new desired lookup entry.
+  if (!A1101Configure(phyInfo, A1101GetLookup(config)))
+  {
+    return false;
+  }
+  
   #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_RX_TIMEOUT )
   // Recalculate Rx timeout value based on the new configuration.
-  PhyCalculateRxTimeout(phyInfo->module.lookup->baudRate.value,
-                          phyInfo->module.lookup->baudRate.scaleFactor);
+  PhyCalculateRxTimeout();
   #endif
   
-  // Completely reconfigure all registers to the certified settings with the 
-  // new desired lookup entry.
-  return A1101Configure(phyInfo, A1101GetLookup(config));
+  #if defined( PHY_USE_FIFO_STREAMING )
+  PhyStreamConfigure(phyInfo);
+  #endif
+  
+  PhyApplyOutputPower();
+  A1101SetAddr(phyInfo, addr);
+  A1101SetPktctrl1(phyInfo, (phyInfo->module.lookup->certified.pktctrl1 & ~(CC1101_ADR_CHK)) 
+                            | (pktctrl1 & CC1101_ADR_CHK));
+  
+  // Error: the channel has not been approved for the new configuration.
+  return A1101SetChannr(phyInfo, channr);
 }
 
 void PhyEnableAddressFilter(unsigned char deviceAddr)
@@ -445,45 +845,177 @@ bool PhySetChannel(unsigned char channel)
 
 void PhySetOutputPower(tPower power)
 {
+  signed int level;
+  signed int selected;
+  unsigned char entry;
+  
   // Set physical hardware to an active state.
   PhyActiveMode();
   
-  //  TODO: Determine the appropriate implementation of this function.
-//  memset(PHYINFO_CAST(gPhyDevice.phyInfo)->module.paTable, 
-//         power, 
-//         sizeof(PHYINFO_CAST(gPhyDevice.phyInfo)->module.paTable));
-//  A1101SetPaTable(PHYINFO_CAST(gPhyDevice.phyInfo), PHYINFO_CAST(gPhyDevice.phyInfo)->module.paTable);
+  // Keep the lowest power level reaching the requested power, otherwise the
+  // highest power level available.
+  if (power > 127)
+  {
+    power = 127;
+  }
+  else if (power < -128)
+  {
+    power = -128;
+  }
+  power = POWER_TO_VALUE(power);
+  
+  gPhyPowerEntry = 0;
+  for (entry = 1; entry < A1101GetPowerLookupSize(); entry++)
+  {
+    level = A1101GetPowerLookup(entry)->dBm;
+    selected = A1101GetPowerLookup(gPhyPowerEntry)->dBm;
+    
+    if ((level >= power && (selected < power || level < selected))
+        || (selected < power && level > selected))
+    {
+      gPhyPowerEntry = entry;
+    }
+  }
+  
+  PhyApplyOutputPower();
 }
 
 // -----------------------------------------------------------------------------
 // Physical status
 
-// TODO: Determine correct implementation for this function. The current version
-// does not take into account issues with timing (when RSSI is valid).
-//tPower PhyGetInstantSignalStrength()
-//{
-//  PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
-//  tPower dBm;
-//  
-//  // Set physical hardware to an active state.
-//  PhyActiveMode();
-//  
-//  // Put the radio into receive and read the instantaneous RSSI value.
-//  CC1101ReceiverOn(&phyInfo->cc1101);
-//  
-//  // TODO: Implement averaging of the RSSI value.
-//  dBm = A1101R09GetRssiDbm(phyInfo, 0);
-//  
-//  CC1101Idle(&phyInfo->cc1101);
-//  
-//  return dBm;
-//}
+tPower PhyGetInstantSignalStrength()
+{
+  PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+  unsigned int tick = 0;
+  signed int sum = 0;
+  unsigned char sample;
+  
+  // Set physical hardware to an active state.
+  PhyActiveMode();
+  
+  // Put the radio into receive. The RSSI is valid once the receiver has 
+  // settled; the first sample is discarded as it may predate the settling.
+  CC1101ReceiverOn(&phyInfo->cc1101);
+  while (CC1101GetMarcState(&phyInfo->cc1101) != eCC1101MarcStateRx)
+  {
+    if (++tick > PHY_RSSI_RX_TIMEOUT)
+    {
+      break;
+    }
+  }
+  CC1101GetRssiWithSpiSyncProblem(&phyInfo->cc1101);
+  
+  // Average the absolute readings (1/2 dB resolution).
+  for (sample = 0; sample < PHY_RSSI_SAMPLES; sample++)
+  {
+    signed char rssi = (signed char)CC1101GetRssiWithSpiSyncProblem(&phyInfo->cc1101);
+    sum += A1101ConvertRssiToDbm(phyInfo, rssi);
+  }
+  
+  CC1101Idle(&phyInfo->cc1101);
+  
+  return (tPower)(((sum / PHY_RSSI_SAMPLES) + 1) >> 1);
+}
+
+unsigned char PhyScanChannels(unsigned char *channel, 
+                              tPower *power, 
+                              unsigned char count)
+{
+  PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+  const struct sA110x2500ChannelList *list = phyInfo->module.lookup->channelList;
+  unsigned int size = 256;
+  unsigned char ranked = 0;
+  unsigned char restore;
+  unsigned int i;
+  
+  // Set physical hardware to an active state.
+  PhyActiveMode();
+  restore = CC1101GetRegister(&phyInfo->cc1101, CC1101_REG_CHANNR);
+  
+  // Only the listed channels are swept if the list holds approved channels.
+  // Otherwise, every channel number is tried and disapproved channels are 
+  // skipped.
+  if (list != NULL && list->listApproval == eA110x2500ChannelListApproved)
+  {
+    size = list->size;
+  }
+  
+  for (i = 0; i < size; i++)
+  {
+    unsigned char value = (size == 256) ? (unsigned char)i : list->list[i];
+    unsigned char position = ranked;
+    tPower dBm;
+    
+    if (!A1101SetChannr(phyInfo, value))
+    {
+      continue;
+    }
+    dBm = PhyGetInstantSignalStrength();
+    
+    // Insert the channel into the ranking (quietest first).
+    while (position > 0 && power[position - 1] > dBm)
+    {
+      if (position < count)
+      {
+        channel[position] = channel[position - 1];
+        power[position] = power[position - 1];
+      }
+      position--;
+    }
+    if (position < count)
+    {
+      channel[position] = value;
+      power[position] = dBm;
+      if (ranked < count)
+      {
+        ranked++;
+      }
+    }
+  }
+  
+  A1101SetChannr(phyInfo, restore);
+  
+  return ranked;
+}
+
+tPower PhyGetOutputPower()
+{
+  PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+  signed int level = A1101GetPowerLookup(gPhyPowerEntry)->dBm;
+  
+  // The module limits the level to the maximum power of the configuration.
+  if (level > phyInfo->module.lookup->maxPower.dBm)
+  {
+    level = phyInfo->module.lookup->maxPower.dBm;
+  }
+  
+  // Round to the nearest dBm.
+  return (level + 128) >> 8;
+}
 
 struct sPhyDataStreamFooter* PhyGetDataStreamStatus()
 {
   return &gPhyDevice.stream.footer;
 }
 
+tTime PhyGetAirtime(unsigned char length)
+{
+  PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+  unsigned long bits = PHY_PREAMBLE_LENGTH + PHY_SYNC_LENGTH + 
+                       PROTOCOL_DATASTREAM_HEADER_LENGTH + length + PHY_CRC_LENGTH;
+  unsigned long baud = (unsigned long)phyInfo->module.lookup->baudRate.value * 
+                       phyInfo->module.lookup->baudRate.scaleFactor;
+  
+  // Round up to the next millisecond tick.
+  bits *= 8;
+  return ((bits * 1000) + baud - 1) / baud;
+}
+
+unsigned int PhyGetDutyCycle()
+{
+  return PHYINFO_CAST(gPhyDevice.phyInfo)->module.lookup->maxDutyCycle;
+}
+
 // -----------------------------------------------------------------------------
 // Physical operation
                
@@ -513,21 +1045,30 @@ void PhyReceiverOn(unsigned char *dataField)
   PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
       
 //  // Begin looking for SYNC word (low-to-high transition).
-//  CC1101GdoWaitForAssert(gPhyInfo->cc1101.gdo[0]);
+//  CC1101GdoWaitForAssert(PHY_GDO0);
   // Begin looking for End-of-Packet (EOP) (high-to-low transition).
-  CC1101GdoWaitForDeassert(phyInfo->cc1101.gdo[0]);
+  CC1101GdoWaitForDeassert(PHY_GDO0);
   
   // Set the data buffer being used for received data.
   gPhyDevice.stream.dataField = dataField;
 
   // Set physical hardware to an active state.
   PhyActiveMode();
+  
+  #if defined( PHY_USE_FIFO_STREAMING )
+  // Drain the RX FIFO each time it fills up to its threshold.
+  PhyStreamStart(phyInfo, false);
+  #endif
 
   // Flush the RX FIFO to prepare it for the next RF packet and turn on the
   // receiver.
   CC1101FlushRxFifo(&phyInfo->cc1101);
   CC1101ReceiverOn(&phyInfo->cc1101);
   
+  #if defined( PHY_USE_FIFO_STREAMING )
+  CC1101GdoEnable(PHY_GDO2);
+  #endif
+  
   #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_RX_TIMEOUT )
   // Start the timeout timer.
   /**
@@ -539,15 +1080,37 @@ void PhyReceiverOn(unsigned char *dataField)
   #endif
 }
 
+#if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+void PhyListen()
+{
+  PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+  
+  // Set physical hardware to an active state.
+  PhyActiveMode();
+  
+  // GDO0 also asserts on a received SYNC word, so its interrupt is masked
+  // until it is known whether the radio transmits.
+  CC1101GdoDisable(PHY_GDO0);
+  CC1101FlushTxFifo(&phyInfo->cc1101);
+  CC1101ReceiverOn(&phyInfo->cc1101);
+  gPhyDevice.status.listening = true;
+}
+#endif
+
 bool PhyTransmit(unsigned char *dataField, 
                  unsigned char count)
 {
+  #if defined( PHY_USE_FIFO_STREAMING )
+  if (count > PROTOCOL_DATASTREAM_MAX_SIZE)
+  #else
   if (count > CC1101_TXFIFO_SIZE)
+  #endif
   {
     /**
      *  Error: data stream is too large to transmit. This implementation does 
      *  not support fragmentation of the data stream. Size must be less than or 
-     *  equal to the physical hardware TX FIFO.
+     *  equal to the physical hardware TX FIFO (or PROTOCOL_DATASTREAM_MAX_SIZE
+     *  when the TX FIFO is refilled during the transmission).
      */
     return false;
   }
@@ -555,18 +1118,47 @@ bool PhyTransmit(unsigned char *dataField,
   if (!gPhyDevice.status.transmitting)
   {
     PHYINFO phyInfo = PHYINFO_CAST(gPhyDevice.phyInfo);
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+    bool listened = false;
+    #endif
   
 //    // Begin looking for SYNC word (low-to-high transition).
-//    CC1101GdoWaitForAssert(gPhyInfo->cc1101.gdo[0]);
+//    CC1101GdoWaitForAssert(PHY_GDO0);
     // Begin looking for End-of-Packet (EOP) (high-to-low transition).
-    CC1101GdoWaitForDeassert(phyInfo->cc1101.gdo[0]);
+    CC1101GdoWaitForDeassert(PHY_GDO0);
+    
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+    // The radio is already active (and in RX) if PhyListen has been called.
+    if (!gPhyDevice.status.listening)
+    #endif
+    {
+      // Set physical hardware to an active state.
+      PhyActiveMode();
+    }
     
-    // Set physical hardware to an active state.
-    PhyActiveMode();
+    #if defined( PHY_USE_FIFO_STREAMING )
+    // Refill the TX FIFO each time it drains below its threshold.
+    PhyStreamStart(phyInfo, true);
+    #endif
 
     // Build the data stream and write to the TX FIFO.
     PhyDataStreamBuild(&phyInfo->cc1101, dataField, count);
 
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+    // Listen before talk. GDO0 has been masked by PhyListen.
+    if (gPhyDevice.status.listening)
+    {
+      gPhyDevice.status.listening = false;
+      if (!PhyClearChannelAssessment(phyInfo))
+      {
+        CC1101Idle(&phyInfo->cc1101);
+        CC1101GdoEnable(PHY_GDO0);
+        return false;
+      }
+      listened = true;
+    }
+    #endif
+
     /**
      *  Set the flag before strobing the radio to transmit. This will prevent 
      *  any state issues from occurring if short data streams are being sent and 
@@ -575,6 +1167,28 @@ bool PhyTransmit(unsigned char *dataField,
     gPhyDevice.status.transmitting = true;
     CC1101Transmit(&phyInfo->cc1101);
     
+    #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_CSMA )
+    if (listened)
+    {
+      if (!PhyTransmitAccepted(phyInfo))
+      {
+        gPhyDevice.status.transmitting = false;
+        CC1101Idle(&phyInfo->cc1101);
+        CC1101GdoEnable(PHY_GDO0);
+        return false;
+      }
+      CC1101GdoEnable(PHY_GDO0);
+    }
+    #endif
+    
+    #if defined( PHY_USE_FIFO_STREAMING )
+    // The rest of a long data stream is written as the TX FIFO drains.
+    if (gPhyDevice.stream.offset < (unsigned int)(PROTOCOL_DATASTREAM_HEADER_LENGTH + count))
+    {
+      CC1101GdoEnable(PHY_GDO2);
+    }
+    #endif
+    
     return true;
   }
   
@@ -591,6 +1205,7 @@ void PhyLowPowerMode()
 void PhyTimerInit(unsigned char(*GenericTimer)(void))
 {
   gPhyDevice.timer.running = false;
+  gPhyDevice.timer.held = false;
   gPhyDevice.timer.Generic = GenericTimer;
   
   A110x2500HwTimerInit();
@@ -598,6 +1213,9 @@ void PhyTimerInit(unsigned char(*GenericTimer)(void))
 
 void PhyTimerStart()
 {
+  // A held timer is already counting; it only resumes the generic timer.
+  gPhyDevice.timer.held = false;
+  
   if (!gPhyDevice.timer.running)
   {
     PROTOCOL_CRITICAL_SECTION
@@ -610,7 +1228,12 @@ void PhyTimerStart()
 
 void PhyTimerStop()
 {
-  if (gPhyDevice.timer.running)
+  // Keep counting until the pending radio state transition has completed.
+  if (CC1101StatePending(&gPhyInfo->cc1101))
+  {
+    gPhyDevice.timer.held = true;
+  }
+  else if (gPhyDevice.timer.running)
   {
     PROTOCOL_CRITICAL_SECTION
     (
@@ -621,6 +1244,14 @@ void PhyTimerStop()
   }
 }
 
+void PhyFilterInit(unsigned char filterLength,
+                   bool(*DataStreamFilter)(unsigned char *dataField, 
+                                           unsigned char length))
+{
+  gPhyDevice.status.filterLength = filterLength;
+  gPhyDevice.status.DataStreamFilter = DataStreamFilter;
+}
+
 #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_RX_TIMEOUT )
 void PhySyncTimerInit(unsigned char(*RxTimeout)(void))
 {
@@ -630,16 +1261,61 @@ void PhySyncTimerInit(unsigned char(*RxTimeout)(void))
 }
 #endif
 
+unsigned char PhyTransmitComplete(bool success)
+{
+  // Transmitting data stream has completed. A radio stuck in TX_END has been
+  // reported to the driver error handler; the protocol carries on.
+  gPhyDevice.status.transmitting = false;
+  PROTOCOL_ENABLE_INTERRUPT();
+  return gPhyDevice.status.DataStreamSent();
+}
+
+enum eCC1101MarcState PhyGetTxOffState()
+{
+  switch (CC1101GetRegister(&gPhyInfo->cc1101, CC1101_REG_MCSM1) & CC1101_TXOFF_MODE)
+  {
+    case 0x01:
+      return eCC1101MarcStateFstxon;
+    case 0x02:
+      return eCC1101MarcStateTx;
+    case 0x03:
+      return eCC1101MarcStateRx;
+    default:
+      return eCC1101MarcStateIdle;
+  }
+}
+
 unsigned char PhySyncEopIsr(volatile unsigned char event)
 {
   unsigned char statusMessage = 0;          // Message from callback routine
+  
+  #if defined( PHY_USE_FIFO_STREAMING )
+  // Refill the TX FIFO or drain the RX FIFO once it crosses its threshold. This
+  // is serviced first so that the end of the packet finds the data stream 
+  // offset up to date.
+  if (CC1101GdoEvent(PHY_GDO2, event))
+  {
+    if (gPhyDevice.status.transmitting)
+    {
+      PhyStreamTransmit(gPhyInfo);
+    }
+    else
+    {
+      PhyStreamReceive(gPhyInfo);
+    }
+  }
+  #endif
         
   // Verify that an RF event has triggered an interrupt.
-  if (CC1101GdoEvent(gPhyInfo->cc1101.gdo[0], event))
+  if (CC1101GdoEvent(PHY_GDO0, event))
   {
-    CC1101GdoDisable(gPhyInfo->cc1101.gdo[0]);
+    CC1101GdoDisable(PHY_GDO0);
+    #if defined( PHY_USE_FIFO_STREAMING )
+    // The data stream is complete; the FIFO is not streamed any further.
+    CC1101GdoDisable(PHY_GDO2);
+    #endif
     
-    if (CC1101GdoGetState(gPhyInfo->cc1101.gdo[0]) == eCC1101GdoStateWaitForDeassert)
+    if (CC1101GdoGetState(PHY_GDO0) == eCC1101GdoStateWaitForDeassert)
     {
       // Is the RF event occuring due to reception or transmission completion?
       if (gPhyDevice.status.transmitting)
@@ -647,15 +1323,24 @@ unsigned char PhySyncEopIsr(volatile unsigned char event)
         /**
          *  Note: GDO0 is issued prior to the transmitter being completely
          *  finished. The state machine will remain in TX_END until transmission
-         *  completes. The following waits for TX_END to correct the hardware
-         *  behavior.
+         *  completes. Rather than spinning here, the transition to the TXOFF
+         *  state is checked on the physical timer tick, which is held running
+         *  for it if necessary.
          */ 
-        while (CC1101GetMarcState(&gPhyInfo->cc1101) == eCC1101MarcStateTx_end);
-        
-        // Transmitting data stream has completed.
-        gPhyDevice.status.transmitting = false;
-        PROTOCOL_ENABLE_INTERRUPT();
-        statusMessage = gPhyDevice.status.DataStreamSent();
+        if (CC1101GetMarcState(&gPhyInfo->cc1101) == eCC1101MarcStateTx_end)
+        {
+          CC1101SetStateAsync(&gPhyInfo->cc1101, CC1101_SNOP, PhyGetTxOffState(),
+                              PHY_TX_END_TIMEOUT, PhyTransmitComplete);
+          if (!gPhyDevice.timer.running)
+          {
+            PhyTimerStart();
+            gPhyDevice.timer.held = true;
+          }
+        }
+        else
+        {
+          statusMessage = PhyTransmitComplete(true);
+        }
       }
       else
       {
@@ -667,7 +1352,7 @@ unsigned char PhySyncEopIsr(volatile unsigned char event)
       }
     }
     PROTOCOL_DISABLE_INTERRUPT();
-    CC1101GdoEnable(gPhyInfo->cc1101.gdo[0]);
+    CC1101GdoEnable(PHY_GDO0);
   }
 
   return statusMessage;
@@ -675,6 +1360,27 @@ unsigned char PhySyncEopIsr(volatile unsigned char event)
 
 unsigned char PhyTimerIsr()
 {
+  unsigned char statusMessage;              // Message from callback routine
+  
+  // Complete a pending radio state transition first.
+  if (CC1101StatePending(&gPhyInfo->cc1101))
+  {
+    statusMessage = CC1101StateEvent(&gPhyInfo->cc1101);
+    if (gPhyDevice.timer.held)
+    {
+      // The timer only runs for the transition; stop it once it completes.
+      if (!CC1101StatePending(&gPhyInfo->cc1101))
+      {
+        PhyTimerStop();
+      }
+      return statusMessage;
+    }
+    if (statusMessage != 0)
+    {
+      return statusMessage;
+    }
+  }
+  
   #if defined( PROTOCOL_ENDPOINT ) && defined( PROTOCOL_USE_RX_TIMEOUT )
   // If enabled, service the sync timeout timer.
   if (gPhyDevice.timer.rxTimeout.enable)
@@ -764,3 +1470,269 @@ int main(void)
 
 
 #endif  /* TEST_A1101_PHY_BRIDGE */
+
+/**
+ *  To test the data stream read of PhyGetDataStream, define the following in 
+ *  your compiler preprocessor definitions: "TEST_PHY_BRIDGE_RX". The stub runs
+ *  on the host against a simulated RX FIFO. It replaces the platform SPI and 
+ *  GDOx functions (CC1101_STATIC_HAL must be A110x2500); build it with the 
+ *  CC1101 driver and the module, e.g.
+ *
+ *    gcc -DTEST_PHY_BRIDGE_RX -include SimplexTransferLR09Config.h 
+ *        -ffunction-sections -Wl,--gc-sections A110x2500PhyBridge.c CC1101.c
+ *        A110LR09.c
+ */
+#ifdef TEST_PHY_BRIDGE_RX
+
+#if !defined( A110LR09_MODULE )
+#error "Physical Bridge Error: TEST_PHY_BRIDGE_RX is written for the A110LR09 module."
+#endif
+
+/**
+ *  Test Example - count the SPI traffic of PhyGetDataStream and check that a 
+ *  data stream is either read whole into the receive buffer or flushed, never
+ *  read past the end of the buffer.
+ *
+ *  @version    1.0.00
+ *  @date       19 Oct 2026
+ *  @platform   Host PC
+ *  @compiler   Any ANSI C compiler
+ *
+ *  assumptions
+ *  ===========
+ *  - a byte on the bus is counted for the address/command byte and for each 
+ *  data byte of a transaction
+ *  - the simulated chip returns the same RXBYTES value on every read, so the 
+ *  SPI read synchronization workaround reads it twice
+ *  - the radio is IDLE at the end of the packet, so SFRX flushes the RX FIFO
+ *
+ *  file dependency
+ *  ===============
+ *  stdio.h : used to report the results
+ *  string.h : memset, memcmp
+ *
+ *  revision history
+ *  ================
+ *  ver 1.0.00 : 19 Oct 2026
+ *  - initial release
+ */
+#include <stdio.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+
+#define TEST_DATA_FIELD_LENGTH  10    // Data field of the received data stream
+#define TEST_FILTER_LENGTH      1     // Data field bytes checked by the filter
+#define TEST_ADDRESS            0x5A  // First data field byte accepted
+#define TEST_GUARD              0xA5  // Guard byte after the receive buffer
+
+struct sTestCount
+{
+  unsigned int readTransactions;
+  unsigned int readBytes;
+  unsigned int writeTransactions;
+  unsigned int writeBytes;
+};
+
+// Simulated RX FIFO.
+static unsigned char gChipRxFifo[64];
+static unsigned char gChipRxHead;
+static unsigned char gChipRxCount;
+
+// Receive buffer (length field, data field and appended status) followed by 
+// guard bytes.
+static unsigned char gTestBuffer[PROTOCOL_DATASTREAM_OVERHEAD + TEST_DATA_FIELD_LENGTH + 4];
+
+static struct sTestCount gCount;
+static unsigned int gFailures = 0;
+
+// -----------------------------------------------------------------------------
+
+void A110x2500SpiInit()
+{
+}
+
+void A110x2500SpiRead(unsigned char address, unsigned char *buffer, unsigned char count)
+{
+  unsigned char reg = address & 0x3F;
+  unsigned char i;
+  
+  gCount.readTransactions++;
+  gCount.readBytes += 1 + count;
+  
+  for (i = 0; i < count; i++)
+  {
+    if (reg == CC1101_RXFIFO && gChipRxCount > 0)
+    {
+      buffer[i] = gChipRxFifo[gChipRxHead++];
+      gChipRxCount--;
+    }
+    else if (reg == CC1101_RXBYTES)
+    {
+      buffer[i] = gChipRxCount;
+    }
+    else
+    {
+      buffer[i] = 0;
+    }
+  }
+}
+
+void A110x2500SpiWrite(unsigned char address, const unsigned char *buffer, unsigned char count)
+{
+  gCount.writeTransactions++;
+  gCount.writeBytes += 1 + count;
+  
+  if (count == 0 && (address & 0x3F) == CC1101_SFRX)
+  {
+    gChipRxHead = 0;
+    gChipRxCount = 0;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+static void TestCountReset(void)
+{
+  memset(&gCount, 0, sizeof(gCount));
+}
+
+static void TestExpect(const char *name, unsigned int value, unsigned int expected)
+{
+  printf("  %-44s %4u (expected %u)\n", name, value, expected);
+  if (value != expected)
+  {
+    gFailures++;
+  }
+}
+
+/**
+ *  TestFilter - accept the data streams addressed to TEST_ADDRESS that fit into
+ *  the receive buffer (as FrameFilter does).
+ */
+unsigned char TestFilter(unsigned char *dataField, unsigned char length)
+{
+  return (dataField[0] == TEST_ADDRESS && length <= TEST_DATA_FIELD_LENGTH);
+}
+
+/**
+ *  TestLoad - put a data stream into the RX FIFO and clear the receive buffer.
+ *
+ *    @param  lengthField   Value of the length field.
+ *    @param  length        Number of data field bytes in the RX FIFO.
+ *    @param  address       First data field byte.
+ */
+static void TestLoad(unsigned char lengthField, unsigned char length, 
+                     unsigned char address)
+{
+  unsigned char i;
+  
+  gChipRxHead = 0;
+  gChipRxCount = 0;
+  gChipRxFifo[gChipRxCount++] = lengthField;
+  gChipRxFifo[gChipRxCount++] = address;
+  for (i = 1; i < length; i++)
+  {
+    gChipRxFifo[gChipRxCount++] = i;
+  }
+  gChipRxFifo[gChipRxCount++] = 0x40;                  // RSSI
+  gChipRxFifo[gChipRxCount++] = 0x80 | 0x2F;           // CRC_OK, LQI
+  
+  memset(gTestBuffer, TEST_GUARD, sizeof(gTestBuffer));
+  TestCountReset();
+}
+
+/**
+ *  TestGuard - check the bytes following the receive buffer.
+ */
+static unsigned int TestGuard(void)
+{
+  unsigned int i;
+  
+  for (i = PROTOCOL_DATASTREAM_OVERHEAD + TEST_DATA_FIELD_LENGTH; i < sizeof(gTestBuffer); i++)
+  {
+    if (gTestBuffer[i] != TEST_GUARD)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ *  TestRead - read a data stream addressed to this device without and with the
+ *  filter.
+ */
+static void TestRead(void)
+{
+  printf("PhyGetDataStream, %u byte data field\n", TEST_DATA_FIELD_LENGTH);
+  
+  gPhyDevice.status.DataStreamFilter = NULL;
+  TestLoad(TEST_DATA_FIELD_LENGTH, TEST_DATA_FIELD_LENGTH, TEST_ADDRESS);
+  PhyGetDataStream();
+  TestExpect("no filter: SPI transactions", gCount.readTransactions + gCount.writeTransactions, 3);
+  TestExpect("no filter: SPI bytes", gCount.readBytes, TEST_DATA_FIELD_LENGTH + 8);
+  TestExpect("no filter: data stream length", gPhyDevice.stream.header.length, TEST_DATA_FIELD_LENGTH);
+  TestExpect("no filter: data stream complete", 
+             memcmp(gTestBuffer, gChipRxFifo, PROTOCOL_DATASTREAM_OVERHEAD + TEST_DATA_FIELD_LENGTH) == 0, 1);
+  
+  gPhyDevice.status.DataStreamFilter = TestFilter;
+  TestLoad(TEST_DATA_FIELD_LENGTH, TEST_DATA_FIELD_LENGTH, TEST_ADDRESS);
+  PhyGetDataStream();
+  TestExpect("filter: SPI transactions", gCount.readTransactions + gCount.writeTransactions, 4);
+  TestExpect("filter: SPI bytes", gCount.readBytes, TEST_DATA_FIELD_LENGTH + 9);
+  TestExpect("filter: data stream length", gPhyDevice.stream.header.length, TEST_DATA_FIELD_LENGTH);
+  TestExpect("filter: data stream complete", 
+             memcmp(gTestBuffer, gChipRxFifo, PROTOCOL_DATASTREAM_OVERHEAD + TEST_DATA_FIELD_LENGTH) == 0, 1);
+}
+
+/**
+ *  TestReject - data streams that must be flushed after the filter bytes: one 
+ *  for another device, one larger than the receive buffer and one whose length
+ *  field does not match the RX FIFO.
+ */
+static void TestReject(void)
+{
+  printf("PhyGetDataStream, rejected data streams\n");
+  
+  gPhyDevice.status.DataStreamFilter = TestFilter;
+  
+  TestLoad(TEST_DATA_FIELD_LENGTH, TEST_DATA_FIELD_LENGTH, TEST_ADDRESS + 1);
+  PhyGetDataStream();
+  TestExpect("other device: SPI read bytes", gCount.readBytes, 7);
+  TestExpect("other device: RX FIFO flushed", gChipRxCount, 0);
+  TestExpect("other device: data stream length", gPhyDevice.stream.header.length, 0);
+  
+  TestLoad(TEST_DATA_FIELD_LENGTH + 20, TEST_DATA_FIELD_LENGTH + 20, TEST_ADDRESS);
+  PhyGetDataStream();
+  TestExpect("too long: SPI read bytes", gCount.readBytes, 7);
+  TestExpect("too long: RX FIFO flushed", gChipRxCount, 0);
+  TestExpect("too long: receive buffer not overrun", TestGuard(), true);
+  TestExpect("too long: data stream length", gPhyDevice.stream.header.length, 0);
+  
+  TestLoad(TEST_DATA_FIELD_LENGTH - 4, TEST_DATA_FIELD_LENGTH + 20, TEST_ADDRESS);
+  PhyGetDataStream();
+  TestExpect("length mismatch: SPI read bytes", gCount.readBytes, 7);
+  TestExpect("length mismatch: RX FIFO flushed", gChipRxCount, 0);
+  TestExpect("length mismatch: receive buffer not overrun", TestGuard(), true);
+  TestExpect("length mismatch: data stream length", gPhyDevice.stream.header.length, 0);
+}
+
+int main(void)
+{
+  gPhyDevice.phyInfo = (void*)gPhyInfo;
+  gPhyInfo->module.lookup = A1101GetLookup(0);
+  gPhyDevice.stream.dataField = gTestBuffer + PROTOCOL_DATASTREAM_HEADER_LENGTH;
+  gPhyDevice.status.filterLength = TEST_FILTER_LENGTH;
+  #if defined( PHY_USE_FIFO_STREAMING )
+  gPhyDevice.stream.offset = 0;
+  #endif
+  
+  TestRead();
+  TestReject();
+  
+  printf("%u failure(s)\n", gFailures);
+  return gFailures != 0;
+}
+
+#endif  /* TEST_PHY_BRIDGE_RX */
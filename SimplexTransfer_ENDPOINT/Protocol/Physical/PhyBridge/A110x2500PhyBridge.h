@@ -12,8 +12,8 @@
  *  A110x2500PhyBridge.h - physical bridge implementation using A110x2500-based 
  *		modules.
  *
- *  @version  1.0.01
- *  @date     16 Oct 2012
+ *  @version  1.0.02
+ *  @date     19 Oct 2026
  *  @author   BPB, air@anaren.com
  *
  *  assumptions
@@ -31,12 +31,16 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.02 : 19 Oct 2026
+ *  - added the GDO2 interface (PHY_USE_FIFO_STREAMING)
+ *  - added the interrupt driven SPI transfer engine (RF_SPI_USE_ISR); dropped
+ *  transactions are reported (failed) and passed to the CC1101 error handler
  *  ver 1.0.01 : 16 Oct 2012
  *  - updated internal documentation; comments revised
  *  ver 1.0.00 : 24 Jul 2012 
  *  - initial release
  */
-#define A110X2500_PHY_BRIDGE_INFO  "A110X2500_PHY_BRIDGE 1.0.01"
+#define A110X2500_PHY_BRIDGE_INFO  "A110X2500_PHY_BRIDGE 1.0.02"
    
 #include "PhyBridge.h" 
 
@@ -59,6 +63,26 @@
  *  Defines, enumerations, and structure definitions
  */
 
+#if defined( RF_SPI_USE_ISR )
+/**
+ *  sA110x2500SpiTransaction - SPI transaction descriptor queued to the SPI 
+ *  transfer engine. The direction is given by the R/W bit of the address byte.
+ *
+ *  Note: The descriptor and its buffer belong to the engine from the time it is
+ *  queued until its completion callback is invoked. The callback is also invoked
+ *  for a transaction dropped because the radio did not assert CHIP_RDYn.
+ */
+struct sA110x2500SpiTransaction
+{
+  unsigned char address;                        // Address/command byte
+  unsigned char *buffer;                        // Buffer read into or written from
+  unsigned char count;                          // Number of data bytes
+  void(*Complete)(void);                        // Completion callback (or NULL)
+  bool failed;                                  // No CHIP_RDYn; nothing transferred
+  struct sA110x2500SpiTransaction *next;        // Next queued transaction
+};
+#endif
+
 // -----------------------------------------------------------------------------
 /**
  *  Global data
@@ -99,6 +123,28 @@ void A110x2500SpiWrite(unsigned char address,
 																						 const unsigned char *buffer,
 																							unsigned char count);
 
+#if defined( RF_SPI_USE_ISR )
+/**
+ *  A110x2500SpiQueue - queue a transaction to the SPI transfer engine. The 
+ *  transfer is driven by the USCIB0 receive interrupt; MISO is kept in SPI 
+ *  function until the queue is empty.
+ *
+ *  Note: Completion callbacks are invoked from the interrupt. They may queue
+ *  another transaction but must not call A110x2500SpiRead/A110x2500SpiWrite.
+ *
+ *    @param  transaction Transaction descriptor.
+ */
+void A110x2500SpiQueue(struct sA110x2500SpiTransaction *transaction);
+
+/**
+ *  A110x2500SpiWait - wait in LPM0 until all queued transactions are complete.
+ *  Interrupts are enabled while waiting; the caller's interrupt state is 
+ *  restored on return. A caller with the interrupts disabled (e.g. an interrupt
+ *  service routine) runs the transfer engine polled instead.
+ */
+void A110x2500SpiWait(void);
+#endif
+
 /**
  *  A110x2500Gdo0Init - initialize the GDO0 port.
  */
@@ -140,6 +186,49 @@ enum eCC1101GdoState A110x2500Gdo0GetState(void);
  */
 void A110x2500Gdo0Enable(bool en);
 
+#if defined( PHY_USE_FIFO_STREAMING )
+/**
+ *  A110x2500Gdo2Init - initialize the GDO2 port.
+ */
+void A110x2500Gdo2Init(void);
+
+/**
+ *  A110x2500Gdo2Event - determine if the GDO2 port has caused an interrupt.
+ *
+ *    @param  event Bit field (or register) with current interrupt flags values.
+ *
+ *    @return True if a GDO2 event has occurred (interrupt), otherwise false
+ *            (the interrupt was due to another source).
+ */
+bool A110x2500Gdo2Event(unsigned char event);
+
+/**
+ *  A110x2500Gdo2WaitForAssert - change the polarity of the GDO2 interrupt to wait
+ *  for an assertion.
+ */
+void A110x2500Gdo2WaitForAssert(void);
+
+/**
+ *  A110x2500Gdo2WaitForDeassert - change the polarity of the GDO2 interrupt to wait
+ *  for a deassertion.
+ */
+void A110x2500Gdo2WaitForDeassert(void);
+
+/**
+ *  A110x2500Gdo2GetState - get the current GDO2 interrupt polarity.
+ *
+ *    @return Current polarity state (waiting for assert or deassert).
+ */
+enum eCC1101GdoState A110x2500Gdo2GetState(void);
+
+/**
+ *  A110x2500Gdo2Enable - enable/disable the GDO2 interrupt.
+ *
+ *    @param  en  Enable flag.
+ */
+void A110x2500Gdo2Enable(bool en);
+#endif
+
 /**
  *  A110x2500HardwareTimerInit - initialize the hardware timer.
  *
@@ -65,7 +65,30 @@
     BCSCTL1 = CALBC1_8MHZ;\
     DCOCTL = CALDCO_8MHZ;\
   )
-#define McuSleep()    _BIS_SR(LPM4_bits | GIE)  // Low power mode 4
+/**
+ *  The protocol timer (Timer1_A) runs from SMCLK, which low power mode 4 stops.
+ *  It runs all the time with PROTOCOL_USE_TIMER (TDMA beacons, reassembly 
+ *  timeout) and otherwise completes a transmission ending in TX_END, so sleep 
+ *  in low power mode 0 while it may be needed. The interrupts are disabled by
+ *  the caller; the protocol ISRs wake the loop up to check again.
+ */
+#if defined( PROTOCOL_USE_TIMER )
+#define McuSleep()    _BIS_SR(LPM0_bits | GIE)  // Low power mode 0
+#else
+#define McuSleep()\
+  ST\
+  (\
+    if (ProtocolBusy())\
+    {\
+      _BIS_SR(LPM0_bits | GIE);\
+    }\
+    else\
+    {\
+      _BIS_SR(LPM4_bits | GIE);\
+    }\
+  )
+#endif
+#define McuWakeup()   __bic_SR_register_on_exit(LPM4_bits)
 #define GDO0_VECTOR   PORT2_VECTOR
 #define GDO0_EVENT    P2IFG
 #endif
@@ -269,6 +292,7 @@ int main(void)
   while (true)
   {
     // Put the microcontroller into a low power state (sleep).
+    __disable_interrupt();
     McuSleep();
   }
 }
@@ -300,10 +324,42 @@ __interrupt void GDO0Isr(void)
    *  event in this ISR.
    */
   ProtocolEngine(event);
+  
+  // The protocol may have started a transmission; choose the sleep mode again.
+  McuWakeup();
 }
 
-// Note: No hardware timer interrupt required for this example because the 
-// Gateway node does not use it for anything at this time.
+#if defined( PHY_USE_FIFO_STREAMING ) && (defined( RF_GDO2_2 ) || defined( RF_GDO2_3 ))
+/**
+ *  GDO2Isr - GDO2 interrupt service routine for a GDO2 position on port 1. The
+ *  FIFO threshold events of a streamed data stream are passed to the protocol 
+ *  the same way as the GDO0 events.
+ */
+#pragma vector=PORT1_VECTOR
+__interrupt void GDO2Isr(void)
+{
+  register volatile unsigned char event = P1IFG;
+  
+  // Clearing of the GDO2 event is handled internally (see GDO0Isr).
+  ProtocolEngine(event);
+  
+  McuWakeup();
+}
+#endif
+
+/**
+ *  TimerIsr - Timer1_A CCR0 interrupt service routine. The protocol timer 
+ *  schedules the TDMA beacons, ages the reassembly buffers and completes a 
+ *  transmission ending in TX_END.
+ */
+#pragma vector=TIMER1_A0_VECTOR
+__interrupt void TimerIsr(void)
+{
+  // Notify the protocol of a timer tick.
+  ProtocolEngineTick();
+  
+  McuWakeup();
+}
 
 
 
@@ -454,8 +510,16 @@ __interrupt void USCI0TX_ISR(void)
 */
 }
 
-// USCI A0/B0 Receive ISR
+// USCI A0/B0 Receive ISR. The SPI transfer engine owns the shared vector and
+// calls this handler for USCIA0 (RF_SPI_SHARED_RX_ISR).
+#if defined( RF_SPI_USE_ISR )
+#if !defined( RF_SPI_SHARED_RX_ISR )
+#error "Gateway Error 0100: RF_SPI_USE_ISR requires RF_SPI_SHARED_RX_ISR as USCIAB0RX_VECTOR is shared."
+#endif
+void USCI0RX_ISR(void)
+#else
 #pragma vector=USCIAB0RX_VECTOR
 __interrupt void USCI0RX_ISR(void)
+#endif
 {
 }
@@ -71,15 +71,33 @@
 #define RF_SPI_CSN_1                    // Default CSn position
 #define RF_GDO0_1                       // Default GDO0 position
 #define TIMER1_A                        // Protocol uses Timer1_A3
+//#define RF_SPI_USE_ISR                  // SPI bursts of 8+ bytes run from the USCIB0 interrupt in LPM0 (pays off with RF_SPI_CLOCK_DIVIDER > 2)
+//#define RF_SPI_SHARED_RX_ISR USCI0RX_ISR // UART receive handler called by the SPI engine (required with RF_SPI_USE_ISR)
+#define CC1101_STATIC_HAL A110x2500     // Call the platform SPI/GDOx functions directly (undefine for the host emulator)
     
 // -----------------------------------------------------------------------------
 /**
  *  Physical radio characteristics
  */
 
-#define A110LR09_FCC_2FSK_1_2_KBAUD       // Configuration => 2FSK, 1.2kBaud, 902MHz
+#define A110LR09_FCC_2FSK_1_2_KBAUD       // Configuration => 2FSK, 1.2kBaud, 902MHz (base profile)
+//#define A110LR09_FCC_2FSK_38_KBAUD      // Configuration => 2FSK, 38kBaud, 902MHz (PROTOCOL_USE_ADR)
+//#define A110LR09_FCC_2FSK_100_KBAUD     // Configuration => 2FSK, 100kBaud, 902MHz (PROTOCOL_USE_ADR)
+//#define A110LR09_FCC_2FSK_250_KBAUD     // Configuration => 2FSK, 250kBaud, 902MHz (PROTOCOL_USE_ADR)
 #define A110LR09_POWER_7_0_DBM            // Power table setting => 7.0dBm
+//#define A110LR09_POWER_4_0_DBM          // Power table setting => 4.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_0_0_DBM          // Power table setting => 0.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_5_0_DBM      // Power table setting => -5.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_10_0_DBM     // Power table setting => -10.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_15_0_DBM     // Power table setting => -15.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_20_0_DBM     // Power table setting => -20.0dBm (PROTOCOL_USE_TPC)
+//#define A110LR09_POWER_NEG_30_0_DBM     // Power table setting => -30.0dBm (PROTOCOL_USE_TPC)
+//#define CC1101_REGISTER_SHADOW          // Serve configuration register reads from RAM (48 bytes)
+//#define A110LR09_WARM_START             // Reuse the radio configuration across a processor reset (needs CC1101_REGISTER_SHADOW)
 #define PHY_MAX_TXFIFO_SIZE         64    // Physical hardware absolute FIFO size
+//#define PHY_USE_FIFO_STREAMING            // Refill/drain the FIFOs on the GDO2 threshold (data streams up to 255 bytes)
+//#define PHY_MAX_DATASTREAM_SIZE     255   // Largest streamed data stream (the frame buffer must hold it)
+//#define RF_GDO2_2                       // GDO2 position (PHY_USE_FIFO_STREAMING; P1.3, served by GDO2Isr)
 
 // -----------------------------------------------------------------------------
 /**
@@ -87,10 +105,32 @@
  */
 
 #define PROTOCOL_GATEWAY                        // Node role
-#define PROTOCOL_CHANNEL_LIST               0   // Physical channel list (comma seperated)
+#define PROTOCOL_CHANNEL_LIST               0   // Physical channel list (comma seperated; control channel first)
 #define PROTOCOL_CHANNEL_LIST_SIZE          1   // Physical channel list size
 #define PROTOCOL_PHYADDRESS_PANID_SIZE      1   // Physical address PAN identifier size
 #define PROTOCOL_PHYADDRESS_ADDRESS_SIZE    1   // Physical address size
-#define PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH  10   // Maximum frame payload length
+#define PROTOCOL_FRAME_MAX_PAYLOAD_LENGTH  11   // Maximum frame payload length (sizeof(struct sPacket); 15 with PROTOCOL_USE_TPC)
+//#define PROTOCOL_USE_ACK                        // Acknowledge data frames that request it (~4 bytes RAM)
+//#define PROTOCOL_USE_TDMA                       // Broadcast beacons and assign transmit slots (~18 bytes RAM)
+//#define PROTOCOL_TDMA_SLOTS                 8   // Transmit slots per superframe (End Points per Gateway)
+//#define PROTOCOL_TDMA_SLOT_LENGTH           350 // Slot length (1ms timer ticks)
+//#define PROTOCOL_USE_GROUP_ACK                  // Acknowledge slot frames in the next beacon (~10 bytes RAM)
+//#define PROTOCOL_USE_CHANNEL_AGILITY            // Serve the transmit slots on the data channels of the channel list (~22 bytes RAM; 2+ channels)
+//#define PROTOCOL_USE_ADR                        // Serve each transmit slot with the fastest profile its RSSI supports (~28 bytes RAM)
+//#define PROTOCOL_ADR_PROFILES               4   // Physical configurations (slowest first)
+//#define PROTOCOL_ADR_SENSITIVITY            -111, -102, -97, -90 // Typical sensitivity of each configuration (dBm)
+//#define PROTOCOL_ADR_MARGIN                 10  // RSSI required above the sensitivity (dB)
+//#define PROTOCOL_USE_TPC                        // Step the slot output power down to the link margin (~8 bytes RAM)
+//#define PROTOCOL_TPC_SENSITIVITY            -111 // Typical sensitivity of the configuration without PROTOCOL_USE_ADR (dBm)
+//#define PROTOCOL_TPC_MARGIN                 10  // RSSI kept above the sensitivity (dB)
+//#define PROTOCOL_TPC_HYSTERESIS             4   // Headroom before lowering the output power (dB)
+//#define PROTOCOL_USE_DUTY_CYCLE                 // Hold frames back at the duty cycle of the configuration (ETSI) (~6 bytes RAM; needs PROTOCOL_USE_TDMA)
+//#define PROTOCOL_DUTY_CYCLE_WINDOW          3600 // Duty cycle observation window (seconds)
+//#define PROTOCOL_DUTY_CYCLE_BURST           3   // Burst share of the window airtime (2^-n)
+//#define PROTOCOL_USE_FRAGMENTATION              // Reassemble data messages sent as fragments (~110 bytes RAM)
+//#define PROTOCOL_FRAGMENT_BUFFERS           2   // Gateway reassembly buffers
+//#define PROTOCOL_FRAGMENT_MAX_LENGTH        48  // Longest reassembled message (bytes)
+#define PROTOCOL_FRAME_HEADER_LAYOUT        1   // On-air frame header layout (2 with PROTOCOL_USE_DESTINATION_FILTER; End Point and Gateway must match)
+//#define PROTOCOL_USE_DESTINATION_FILTER         // Lead frames with the destination address and filter it in hardware (changes the on-air frame header)
 
 #endif  /* SIMPLEX_TRANSFER_LR09_CONFIG_H */
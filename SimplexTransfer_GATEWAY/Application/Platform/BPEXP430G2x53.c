@@ -11,8 +11,8 @@
  *		in conjunction with an MSP430G2x53 microcontroller. Hardware pins are mapped
  *		based on the EXP430G2 development platform.
  *
- *  @version    1.0.00
- *  @date       08 Oct 2012
+ *  @version    1.0.01
+ *  @date       19 Oct 2026
  *  @author     BPB, air@anaren.com
  *
  *  assumptions
@@ -27,6 +27,18 @@
  *
  *  revision history
  *  ================
+ *  ver 1.0.01 : 19 Oct 2026
+ *  - added the GDO2 interface used for FIFO threshold streaming 
+ *  (PHY_USE_FIFO_STREAMING)
+ *  - added the interrupt driven SPI transfer engine (RF_SPI_USE_ISR); the SPI 
+ *  clock divider is configurable (RF_SPI_CLOCK_DIVIDER)
+ *  - the SPI transfer engine forwards USCIA0 receive interrupts to the 
+ *  application (RF_SPI_SHARED_RX_ISR) and bounds the CHIP_RDYn wait 
+ *  (RF_SPI_CHIP_RDY_TIMEOUT)
+ *  - a transaction dropped by the SPI transfer engine is reported to the CC1101
+ *  error handler (CC1101_ERROR_HANDLING)
+ *  - A110x2500SpiWait runs the SPI transfer engine polled when the caller has
+ *  the interrupts disabled instead of sleeping with them enabled
  *  ver 1.0.00 : 08 Oct 2012
  *  - initial release
  */
@@ -72,6 +84,24 @@
 #define RF_SPI_MISO       (0x0040u)
 #define RF_SPI_MISO_IN    P1IN
 
+// SPI clock divider (SMCLK / RF_SPI_CLOCK_DIVIDER)
+#ifndef RF_SPI_CLOCK_DIVIDER
+#define RF_SPI_CLOCK_DIVIDER  2
+#endif
+
+// Smallest transfer run by the SPI transfer engine. Shorter transfers are 
+// polled as the interrupt overhead exceeds the transfer time.
+#if defined( RF_SPI_USE_ISR ) && !defined( RF_SPI_ISR_MIN_COUNT )
+#define RF_SPI_ISR_MIN_COUNT  8
+#endif
+
+// CHIP_RDYn polls before the SPI transfer engine drops a transaction. The 
+// engine starts transactions from the interrupt, which must not wait on a 
+// radio whose crystal is off (SLEEP or XOFF).
+#if defined( RF_SPI_USE_ISR ) && !defined( RF_SPI_CHIP_RDY_TIMEOUT )
+#define RF_SPI_CHIP_RDY_TIMEOUT  1000
+#endif
+
 // SPI CSn
 #if defined( RF_SPI_CSN_1 )
 // Chip Select position 1 (default) - P2.7
@@ -137,6 +167,50 @@
 #error "Board Error 0102: GDO0 selection invalid. Please select GDO0 position 1, 2, or 3."
 #endif
 
+// GDO2
+// Note: The GDO2 event must be passed to the protocol by the interrupt service
+// routine of its port. The positions are shared with GDO0.
+#if defined( PHY_USE_FIFO_STREAMING )
+#if defined( RF_GDO2_1 )
+// GDO2 selection position 1 - P2.6
+#define RF_GDO2           (0x0040u)
+#define RF_GDO2_IN        P2IN
+#define RF_GDO2_DIR       P2DIR
+#define RF_GDO2_IE        P2IE
+#define RF_GDO2_IES       P2IES
+#define RF_GDO2_IFG       P2IFG
+#define RF_GDO2_SEL       P2SEL
+#define RF_GDO2_SEL2      P2SEL2
+#elif defined( RF_GDO2_2 )
+// GDO2 selection position 2 - P1.3
+#define RF_GDO2           (0x0008u)
+#define RF_GDO2_IN        P1IN
+#define RF_GDO2_DIR       P1DIR
+#define RF_GDO2_IE        P1IE
+#define RF_GDO2_IES       P1IES
+#define RF_GDO2_IFG       P1IFG
+#define RF_GDO2_SEL       P1SEL
+#define RF_GDO2_SEL2      P1SEL2
+#elif defined( RF_GDO2_3 )
+// GDO2 selection position 3 - P1.1
+#define RF_GDO2           (0x0002u)
+#define RF_GDO2_IN        P1IN
+#define RF_GDO2_DIR       P1DIR
+#define RF_GDO2_IE        P1IE
+#define RF_GDO2_IES       P1IES
+#define RF_GDO2_IFG       P1IFG
+#define RF_GDO2_SEL       P1SEL
+#define RF_GDO2_SEL2      P1SEL2
+#else
+#error "Board Error 0104: GDO2 selection invalid. Please select GDO2 position 1, 2, or 3."
+#endif
+
+#if (defined( RF_GDO0_1 ) && defined( RF_GDO2_1 )) || (defined( RF_GDO0_2 ) && defined( RF_GDO2_2 ))\
+    || (defined( RF_GDO0_3 ) && defined( RF_GDO2_3 ))
+#error "Board Error 0105: GDO0 and GDO2 cannot share the same position."
+#endif
+#endif
+
 /**
  *  Timer control
  */
@@ -163,11 +237,122 @@
  *  Global data
  */
 
+#if defined( RF_SPI_USE_ISR )
+// SPI transfer engine queue. The head is the transaction on the bus.
+static struct sA110x2500SpiTransaction *volatile gSpiHead = NULL;
+static struct sA110x2500SpiTransaction *gSpiTail = NULL;
+static volatile unsigned char gSpiOffset = 0;   // Data bytes clocked out
+#endif
+
 // -----------------------------------------------------------------------------
 /**
  *  Private interface
  */
 
+#if defined( RF_SPI_USE_ISR )
+bool A110x2500SpiStart(struct sA110x2500SpiTransaction *transaction)
+{
+  unsigned int timeout = RF_SPI_CHIP_RDY_TIMEOUT;
+  
+  RF_SPI_CSN_OUT &= ~RF_SPI_CSN;
+  // Look for CHIP_RDYn from radio.
+  while (RF_SPI_MISO_IN & RF_SPI_MISO)
+  {
+    if (--timeout == 0)
+    {
+      RF_SPI_CSN_OUT |= RF_SPI_CSN;
+      transaction->failed = true;
+      return false;
+    }
+  }
+  
+  // Write the address/command byte; the data bytes follow from the interrupt.
+  transaction->failed = false;
+  gSpiOffset = 0;
+  UCB0TXBUF = transaction->address;
+  return true;
+}
+
+/**
+ *  A110x2500SpiNext - start the queued transactions from the head until one is
+ *  on the bus. The failed ones are completed without a transfer.
+ *
+ *    @return Returns true if the queue is empty.
+ */
+bool A110x2500SpiNext()
+{
+  struct sA110x2500SpiTransaction *transaction;
+  
+  while (gSpiHead != NULL)
+  {
+    if (A110x2500SpiStart(gSpiHead))
+    {
+      return false;
+    }
+    
+    transaction = gSpiHead;
+    gSpiHead = transaction->next;
+    if (transaction->Complete != NULL)
+    {
+      transaction->Complete();
+    }
+  }
+  
+  // Change MISO pin to general purpose output (LED use if available).
+  IE2 &= ~UCB0RXIE;
+  P1SEL &= ~RF_SPI_MISO;
+  P1SEL2 &= ~RF_SPI_MISO;
+  return true;
+}
+
+/**
+ *  A110x2500SpiService - SPI transfer engine. Each received byte completes a 
+ *  byte on the bus; the first one of a transaction is the chip status.
+ *
+ *    @return Returns true if the last queued transaction has completed.
+ */
+bool A110x2500SpiService()
+{
+  struct sA110x2500SpiTransaction *transaction = gSpiHead;
+  bool read;
+  bool empty;
+  unsigned char rx;
+  
+  if (!(IFG2 & UCB0RXIFG) || !(IE2 & UCB0RXIE) || transaction == NULL)
+  {
+    return false;
+  }
+  
+  read = (transaction->address & CC1101_READ_SINGLE) != 0;
+  rx = UCB0RXBUF;                       // Clears UCB0RXIFG
+  
+  if (read && gSpiOffset > 0)
+  {
+    transaction->buffer[gSpiOffset - 1] = rx;
+  }
+  
+  if (gSpiOffset < transaction->count)
+  {
+    UCB0TXBUF = read ? 0xFF : transaction->buffer[gSpiOffset];
+    gSpiOffset++;
+    return false;
+  }
+  
+  // The transaction is complete; raising CSn ends a burst access.
+  RF_SPI_CSN_OUT |= RF_SPI_CSN;
+  gSpiHead = transaction->next;
+  empty = A110x2500SpiNext();
+  
+  // The callback may queue the next transaction.
+  if (transaction->Complete != NULL)
+  {
+    transaction->Complete();
+  }
+  
+  return empty;
+}
+#endif
+
 // -----------------------------------------------------------------------------
 /**
  *  Public interface
@@ -190,7 +375,7 @@ void A110x2500SpiInit()
   UCB0CTL0 |= (UCMODE_0 | UCCKPH | UCMSB | UCMST | UCSYNC);
   UCB0CTL1 |= UCSSEL_2;
   UCB0BR1 = 0;
-  UCB0BR0 = 2;
+  UCB0BR0 = RF_SPI_CLOCK_DIVIDER;
   
   // Setup SCLK, MOSI, and MISO lines.
   P1SEL |= RF_SPI_SCLK | RF_SPI_MOSI | RF_SPI_MISO;
@@ -215,6 +400,31 @@ void A110x2500SpiRead(unsigned char address,
    *  offset.
    */
   unsigned char j;                      // Buffer offset
+  #if defined( RF_SPI_USE_ISR )
+  struct sA110x2500SpiTransaction transaction;
+  
+  // Long bursts run from the SPI interrupt while the processor sleeps. Callers
+  // in a critical section keep the polled transfer.
+  if (count >= RF_SPI_ISR_MIN_COUNT && (__get_SR_register() & GIE))
+  {
+    transaction.address = address;
+    transaction.buffer = buffer;
+    transaction.count = count;
+    transaction.Complete = NULL;
+    A110x2500SpiQueue(&transaction);
+    A110x2500SpiWait();
+    #if defined( CC1101_ERROR_HANDLING )
+    if (transaction.failed)
+    {
+      CC1101ReportError(eCC1101ErrorSpi);
+    }
+    #endif
+    return;
+  }
+  
+  // A polled transfer must not interleave with queued transactions.
+  A110x2500SpiWait();
+  #endif
   
   // Change MISO pin to SPI.
   P1SEL |= RF_SPI_MISO;
@@ -253,6 +463,31 @@ void A110x2500SpiWrite(unsigned char address,
 											 unsigned char count)
 {
   register volatile unsigned char i;    // Buffer iterator
+  #if defined( RF_SPI_USE_ISR )
+  struct sA110x2500SpiTransaction transaction;
+  
+  // Long bursts run from the SPI interrupt while the processor sleeps. Callers
+  // in a critical section keep the polled transfer.
+  if (count >= RF_SPI_ISR_MIN_COUNT && (__get_SR_register() & GIE))
+  {
+    transaction.address = address;
+    transaction.buffer = (unsigned char*)buffer;  // Only read by the engine
+    transaction.count = count;
+    transaction.Complete = NULL;
+    A110x2500SpiQueue(&transaction);
+    A110x2500SpiWait();
+    #if defined( CC1101_ERROR_HANDLING )
+    if (transaction.failed)
+    {
+      CC1101ReportError(eCC1101ErrorSpi);
+    }
+    #endif
+    return;
+  }
+  
+  // A polled transfer must not interleave with queued transactions.
+  A110x2500SpiWait();
+  #endif
   
   // Change MISO pin to SPI.
   P1SEL |= RF_SPI_MISO;
@@ -281,6 +516,91 @@ void A110x2500SpiWrite(unsigned char address,
   P1SEL2 &= ~RF_SPI_MISO;
 }
 
+#if defined( RF_SPI_USE_ISR )
+void A110x2500SpiQueue(struct sA110x2500SpiTransaction *transaction)
+{
+  transaction->next = NULL;
+  
+  MCU_CRITICAL_SECTION
+  (
+    if (gSpiHead == NULL)
+    {
+      gSpiHead = transaction;
+      gSpiTail = transaction;
+      
+      // Change MISO pin to SPI for the whole batch.
+      P1SEL |= RF_SPI_MISO;
+      P1SEL2 |= RF_SPI_MISO;
+      
+      IFG2 &= ~UCB0RXIFG;
+      IE2 |= UCB0RXIE;
+      A110x2500SpiNext();
+    }
+    else
+    {
+      gSpiTail->next = transaction;
+      gSpiTail = transaction;
+    }
+  );
+}
+
+void A110x2500SpiWait()
+{
+  unsigned short gie = __get_SR_register() & GIE;   // Caller interrupt state
+  
+  MCU_DISABLE_INTERRUPT();
+  while (gSpiHead != NULL)
+  {
+    if (gie)
+    {
+      // Entering LPM0 enables the interrupts atomically so that the completion
+      // cannot be missed between the check and sleeping.
+      __bis_SR_register(LPM0_bits | GIE);
+      MCU_DISABLE_INTERRUPT();
+    }
+    else
+    {
+      // The caller runs with the interrupts disabled (e.g. an interrupt service
+      // routine); enabling them would nest interrupts. Run the engine polled.
+      A110x2500SpiService();
+    }
+  }
+  
+  if (gie)
+  {
+    MCU_ENABLE_INTERRUPT();
+  }
+}
+
+/**
+ *  A110x2500SpiIsr - SPI transfer engine interrupt.
+ *
+ *  Note: USCIAB0RX_VECTOR is shared with the USCIA0 receiver (the Gateway UART).
+ *  An application receiving on USCIA0 names its handler in RF_SPI_SHARED_RX_ISR
+ *  instead of defining the vector; the handler must read UCA0RXBUF.
+ */
+#if defined( RF_SPI_SHARED_RX_ISR )
+void RF_SPI_SHARED_RX_ISR(void);
+#endif
+
+#pragma vector=USCIAB0RX_VECTOR
+__interrupt void A110x2500SpiIsr(void)
+{
+  #if defined( RF_SPI_SHARED_RX_ISR )
+  if ((IFG2 & UCA0RXIFG) && (IE2 & UCA0RXIE))
+  {
+    RF_SPI_SHARED_RX_ISR();
+  }
+  #endif
+  
+  if (A110x2500SpiService())
+  {
+    // Wake A110x2500SpiWait.
+    __bic_SR_register_on_exit(LPM0_bits);
+  }
+}
+#endif
+
 // -----------------------------------------------------------------------------
 // A110x2500 RF general digital output (GDO)
 
@@ -334,6 +654,58 @@ void A110x2500Gdo0Enable(bool en)
   }
 }
 
+#if defined( PHY_USE_FIFO_STREAMING )
+void A110x2500Gdo2Init()
+{
+  RF_GDO2_DIR &= ~RF_GDO2;
+  RF_GDO2_IES &= ~RF_GDO2;
+  RF_GDO2_IFG &= ~RF_GDO2;
+  RF_GDO2_SEL &= ~RF_GDO2;
+  RF_GDO2_SEL2 &= ~RF_GDO2;
+}
+
+bool A110x2500Gdo2Event(unsigned char event)
+{
+  if (RF_GDO2 & event)
+  {
+    // Clear GDO2 event.
+    RF_GDO2_IFG &= ~RF_GDO2;
+    return true;
+  }
+  return false;
+}
+
+void A110x2500Gdo2WaitForAssert()
+{
+  RF_GDO2_IES &= ~RF_GDO2;
+}
+
+void A110x2500Gdo2WaitForDeassert()
+{
+  RF_GDO2_IES |= RF_GDO2;
+}
+
+enum eCC1101GdoState A110x2500Gdo2GetState()
+{
+  return (RF_GDO2_IES & RF_GDO2) 
+    ? eCC1101GdoStateWaitForDeassert
+      : eCC1101GdoStateWaitForAssert;
+}
+
+void A110x2500Gdo2Enable(bool en)
+{
+  RF_GDO2_IFG &= ~RF_GDO2;
+  if (en)
+  {
+    RF_GDO2_IE |= RF_GDO2;
+  }
+  else
+  {
+    RF_GDO2_IE &= ~RF_GDO2;
+  }
+}
+#endif
+
 // -----------------------------------------------------------------------------
 // Hardware Timer
 
@@ -69,10 +69,20 @@ bool ProtocolInit(const struct sProtocolSetupInfo *setup)
   
   // Setup the Physical layer.
   PhyInit(FrameDisassemble, FrameAssemble);
+  #if defined( PROTOCOL_USE_CHANNEL_AGILITY )
+  // The first channel is the control channel; the others carry the slots.
+  FrameSetChannelList(setup->channel);
+  #else
   PhySetChannel(setup->channel[0]);
+  #endif
+  #if defined( FRAME_USE_TIMER )
+  PhyTimerInit(FrameTimer);
+  #else
   PhyTimerInit(NULL);
+  #endif
   
 	// Setup the Data Link layer.
+  PhyFilterInit(FRAME_HEADER_LENGTH, FrameFilter);
   #if defined( PROTOCOL_ENDPOINT )
   #if defined( PROTOCOL_USE_RX_TIMEOUT )
   PhySyncTimerInit(FrameTimeout);
@@ -124,13 +134,25 @@ bool ProtocolBusy()
   return FrameBusy();
 }
 
+unsigned char ProtocolChannelSurvey(unsigned char *channel, 
+                                    signed int *power, 
+                                    unsigned char count)
+{
+  return FrameChannelSurvey(channel, power, count);
+}
+
 // -----------------------------------------------------------------------------
 // Protocol operations
 
 #if defined( PROTOCOL_ENDPOINT )
 bool ProtocolConnect(const unsigned char *txData, unsigned char length)
 {
+  #if defined( PROTOCOL_USE_TDMA )
+  // A connected End Point also owns a transmit slot.
+  if (!PhyAddressLinkExists() || FrameGetTdmaInfo()->slot == FRAME_TDMA_NO_SLOT)
+  #else
   if (!PhyAddressLinkExists())
+  #endif
   {
     FrameSend(eFrameTypeLinkRequest, true, (unsigned char*)txData, length);
     return false;
@@ -193,3 +215,10 @@ void ProtocolEngineTick()
 {
   PhyTimerIsr();
 }
+
+#if defined( PROTOCOL_USE_DUTY_CYCLE )
+void ProtocolEngineElapsed(unsigned int elapsed)
+{
+  FrameDutyCycleElapsed(elapsed);
+}
+#endif